@@ -0,0 +1,338 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+// Runs the database layer against temporary files under each pragma profile and prints
+// ops/sec and latency percentiles as JSON, so results can be diffed across commits.
+//
+//   database_bench [--rows N] [--profile NAME] [--dir PATH]
+
+#include "Database/Database.hpp"
+#include "Database/Where.hpp"
+#include "AI/ConversationManager.hpp"
+#include "IME/IME.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace
+{
+    // Scan results are stored here so the optimizer cannot drop the reads
+    volatile double sink = 0;
+
+    struct Profile
+    {
+        std::string name;
+        DatabaseOptions options;
+    };
+
+    std::vector<Profile> profiles()
+    {
+        DatabaseOptions unsynced = DatabaseOptions::conversationHistory();
+        unsynced.synchronous = "OFF";
+        unsynced.profile = false;
+        return {
+            {"default", DatabaseOptions()},
+            {"conversationHistory", DatabaseOptions::conversationHistory()},
+            {"userDictionary", DatabaseOptions::userDictionary()},
+            // Lower bound: no fsync and no statement tracing
+            {"walUnsynced", unsynced},
+        };
+    }
+
+    nlohmann::json describe(const DatabaseOptions &options)
+    {
+        return {
+            {"journalMode", options.journalMode},
+            {"synchronous", options.synchronous},
+            {"mmapSize", options.mmapSize},
+            {"cacheSize", options.cacheSize},
+            {"tempStoreMemory", options.tempStoreMemory},
+            {"readConnections", options.readConnections},
+            {"profile", options.profile},
+        };
+    }
+
+    class Timer
+    {
+    private:
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    public:
+        int64_t nanos() const
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        }
+    };
+
+    // Calls operation samples times; each call does opsPerSample logical operations (rows, queries)
+    nlohmann::json measure(const std::string &name, size_t samples, size_t opsPerSample, const std::function<void(size_t)> &operation)
+    {
+        std::vector<int64_t> latencies;
+        latencies.reserve(samples);
+        Timer total;
+        for (size_t i = 0; i < samples; i++)
+        {
+            Timer timer;
+            operation(i);
+            latencies.push_back(timer.nanos());
+        }
+        double seconds = total.nanos() / 1e9;
+
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [&latencies](double p)
+        {
+            if (latencies.empty())
+                return 0.0;
+            size_t rank = (size_t)(p * latencies.size());
+            return latencies[std::min(rank, latencies.size() - 1)] / 1e3;
+        };
+        size_t ops = samples * opsPerSample;
+        return {
+            {"name", name},
+            {"ops", ops},
+            {"seconds", seconds},
+            {"opsPerSec", seconds > 0 ? ops / seconds : 0},
+            {"latencyMicros",
+             {{"p50", percentile(0.50)},
+              {"p90", percentile(0.90)},
+              {"p99", percentile(0.99)},
+              {"max", latencies.empty() ? 0 : latencies.back() / 1e3}}},
+        };
+    }
+
+    void removeDatabase(const std::string &path)
+    {
+        for (const char *suffix : {"", "-wal", "-shm", "-journal"})
+            std::remove((path + suffix).c_str());
+    }
+
+    std::string payload(std::mt19937_64 &random, size_t length)
+    {
+        static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz ";
+        std::string text(length, ' ');
+        for (auto &ch : text)
+            ch = alphabet[random() % (sizeof(alphabet) - 1)];
+        return text;
+    }
+
+    void benchBuilders(const std::string &dir, const DatabaseOptions &options, size_t rows, nlohmann::json &cases)
+    {
+        std::string path = dir + "/builders.db";
+        removeDatabase(path);
+        std::mt19937_64 random(42);
+        {
+            DATABASE database(path, options);
+            database.table("bench")
+                .column("id", TABLE::INTEGER, TABLE::PRIMARY_KEY)
+                .column("key", TABLE::TEXT, TABLE::NOT_NULL)
+                .column("value", TABLE::REAL, TABLE::NOT_NULL)
+                .column("payload", TABLE::TEXT, TABLE::NOT_NULL)
+                .index({"key"})
+                .execute();
+
+            cases.push_back(measure("insert_single", rows, 1, [&](size_t i)
+                                    { database.insert("bench")
+                                          .value("id", (int64_t)i + 1)
+                                          .value("key", "key" + std::to_string(i))
+                                          .value("value", (double)i)
+                                          .value("payload", payload(random, 64))
+                                          .execute(); }));
+
+            const size_t batchSize = 100;
+            cases.push_back(measure("insert_batch", rows / batchSize, batchSize, [&](size_t batch)
+                                    {
+                                        BATCH_INSERT insert = database.batchInsert("bench")
+                                                                  .column("id")
+                                                                  .column("key")
+                                                                  .column("value")
+                                                                  .column("payload");
+                                        for (size_t i = 0; i < batchSize; i++)
+                                        {
+                                            int64_t id = rows + batch * batchSize + i + 1;
+                                            (void)insert.row(id, "key" + std::to_string(id), (double)id, payload(random, 64));
+                                        }
+                                        insert.execute(); }));
+
+            int64_t total = database.size("bench").execute();
+            cases.push_back(measure("select_point", rows, 1, [&](size_t)
+                                    { (void)database.select("bench")
+                                          .select("value")
+                                          .select("payload")
+                                          .where("id", (int64_t)(random() % total) + 1)
+                                          .execute(); }));
+
+            const int64_t rangeSize = 100;
+            cases.push_back(measure("select_range", std::max<size_t>(rows / 10, 1), 1, [&](size_t)
+                                    {
+                                        int64_t low = (int64_t)(random() % (total - rangeSize)) + 1;
+                                        (void)database.select("bench")
+                                            .select("id")
+                                            .select("value")
+                                            .where(WHERE::between("id", low, low + rangeSize - 1))
+                                            .execute(); }));
+
+            cases.push_back(measure("update", rows, 1, [&](size_t i)
+                                    { database.update("bench")
+                                          .set("value", (double)i)
+                                          .where("id", (int64_t)(random() % total) + 1)
+                                          .execute(); }));
+        }
+        removeDatabase(path);
+    }
+
+    void benchConversations(const std::string &dir, const DatabaseOptions &options, nlohmann::json &cases)
+    {
+        std::string path = dir + "/ai.db";
+        removeDatabase(path);
+        std::mt19937_64 random(42);
+        {
+            ConversationManager manager(path, options);
+            for (size_t nodes : {10, 100, 1000})
+            {
+                std::string conversationId;
+                manager.createConversation("bench", conversationId);
+
+                std::unordered_map<std::string, std::unique_ptr<ConversationNode>> nodeMap;
+                std::string parentId;
+                for (size_t i = 0; i < nodes; i++)
+                {
+                    std::string id = conversationId + "-" + std::to_string(i);
+                    auto role = i % 2 ? ConversationNode::ROLE_ASSISTANT : ConversationNode::ROLE_USER;
+                    nodeMap[id] = std::make_unique<ConversationNode>(id, role, payload(random, i % 2 ? 800 : 120), parentId);
+                    if (!parentId.empty())
+                        nodeMap[parentId]->childIds.push_back(id);
+                    parentId = id;
+                }
+
+                size_t samples = std::max<size_t>(1000 / nodes, 5);
+                std::string suffix = "_" + std::to_string(nodes);
+                cases.push_back(measure("conversation_save" + suffix, samples, 1, [&](size_t)
+                                        { manager.saveConversation(conversationId, nodeMap); }));
+                cases.push_back(measure("conversation_load" + suffix, samples, 1, [&](size_t)
+                                        {
+                                            std::unordered_map<std::string, std::unique_ptr<ConversationNode>> loaded;
+                                            std::string rootNodeId, leafNodeId;
+                                            manager.loadConversation(conversationId, loaded, rootNodeId, leafNodeId); }));
+            }
+        }
+        removeDatabase(path);
+    }
+
+    void benchDictionary(const std::string &dir, const DatabaseOptions &options, size_t rows, nlohmann::json &cases)
+    {
+        std::string path = dir + "/ime.db";
+        removeDatabase(path);
+        std::mt19937_64 random(42);
+        {
+            // Let IME create its schema, then fill it with learned words
+            IME ime(path, options);
+        }
+        {
+            DATABASE database(path, options);
+            BATCH_INSERT words = database.batchInsert("ime_dict")
+                                     .column("pinyin")
+                                     .column("hanZi")
+                                     .column("freq");
+            for (size_t i = 0; i < rows; i++)
+                (void)words.row(payload(random, 4) + " " + payload(random, 3), "词" + std::to_string(i), (double)(random() % 1000));
+            words.execute();
+
+            cases.push_back(measure("ime_dict_scan", 20, rows, [&](size_t)
+                                    {
+                                        double sum = 0;
+                                        for (const auto &row : database.select("ime_dict").select("pinyin").select("hanZi").select("freq").cursor())
+                                            sum += row.getDouble(2) + row.getText(0).size() + row.getText(1).size();
+                                        sink = sum; }));
+        }
+        // Whole startup: builtin dictionary parse plus the ime_dict load
+        cases.push_back(measure("ime_initialize", 5, 1, [&](size_t)
+                                {
+                                    IME ime(path, options);
+                                    ime.initialize(); }));
+        removeDatabase(path);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t rows = 2000;
+    std::string only;
+    std::string parent = "/tmp";
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string flag = argv[i];
+        if (flag == "--rows")
+            rows = std::max<size_t>(std::strtoul(argv[i + 1], nullptr, 10), 200);
+        else if (flag == "--profile")
+            only = argv[i + 1];
+        else if (flag == "--dir")
+            parent = argv[i + 1];
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--rows N] [--profile NAME] [--dir PATH]" << std::endl;
+            return 2;
+        }
+    }
+
+    std::string dir = parent + "/database_bench.XXXXXX";
+    if (!mkdtemp(dir.data()))
+    {
+        std::perror("mkdtemp");
+        return 1;
+    }
+
+    nlohmann::json report = {
+        {"sqlite", sqlite3_libversion()},
+        {"rows", rows},
+        {"profiles", nlohmann::json::array()},
+    };
+    try
+    {
+        for (const auto &profile : profiles())
+        {
+            if (!only.empty() && profile.name != only)
+                continue;
+            nlohmann::json cases = nlohmann::json::array();
+            benchBuilders(dir, profile.options, rows, cases);
+            benchConversations(dir, profile.options, cases);
+            benchDictionary(dir, profile.options, rows, cases);
+            report["profiles"].push_back({
+                {"name", profile.name},
+                {"options", describe(profile.options)},
+                {"cases", cases},
+            });
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        rmdir(dir.c_str());
+        return 1;
+    }
+    rmdir(dir.c_str());
+
+    std::cout << report.dump(2) << std::endl;
+    return 0;
+}
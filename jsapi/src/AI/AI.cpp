@@ -17,18 +17,20 @@
 
 #include "AI.hpp"
 #include "strUtils.hpp"
+#include "TokenEstimator.hpp"
 #include <Exceptions/NetworkError.hpp>
 #include <iostream>
 #include <sstream>
 #include <regex>
 #include <chrono>
+#include <future>
 
 AI::AI()
 {
     std::lock_guard<std::mutex> settingsLock(settingsMutex);
     std::lock_guard<std::mutex> conversationLock(conversationMutex);
 
-    conversationManager.loadApiSettings(apiKey, baseUrl, model, maxTokens, temperature, topP, systemPrompt);
+    conversationManager.loadApiSettings(apiKey, baseUrl, model, maxTokens, temperature, topP, systemPrompt, contextTokens);
 
     auto conversationsResponse = conversationManager.getConversationList();
     if (conversationsResponse.empty())
@@ -49,12 +51,20 @@ AI::AI()
         conversationManager.loadConversation(conversationId, nodeMap, rootNodeId, currentNodeId);
     }
 }
+AI::~AI()
+{
+    generations.cancelAll();
+    // Waits out a callback already running; the ones after it see alive cleared and return at once
+    std::lock_guard<std::mutex> lifetimeLock(lifetime->mutex);
+    lifetime->alive = false;
+}
 
-ConversationNode *AI::findNode(const std::string &nodeId)
+ConversationNode *AI::findNode(const std::unordered_map<std::string, std::unique_ptr<ConversationNode>> &nodes, const std::string &nodeId)
 {
-    auto it = nodeMap.find(nodeId);
-    return (it != nodeMap.end()) ? it->second.get() : nullptr;
+    auto it = nodes.find(nodeId);
+    return (it != nodes.end()) ? it->second.get() : nullptr;
 }
+ConversationNode *AI::findNode(const std::string &nodeId) { return findNode(nodeMap, nodeId); }
 
 std::vector<ConversationNode> AI::getPathFromRoot(const std::string &nodeId)
 {
@@ -72,6 +82,85 @@ std::vector<ConversationNode> AI::getPathFromRoot(const std::string &nodeId)
     return path;
 }
 
+// Always keeps the root system prompt and the most recent messages, then
+// adds older messages newest-first while they fit the token budget.
+std::vector<ConversationNode *> AI::buildContext(const std::unordered_map<std::string, std::unique_ptr<ConversationNode>> &nodes,
+                                                const std::string &nodeId, int budget, size_t &omitted)
+{
+    static constexpr size_t MIN_RECENT_MESSAGES = 2;
+
+    std::vector<ConversationNode *> path;
+    for (ConversationNode *node = findNode(nodes, nodeId); node; node = findNode(nodes, node->parentId))
+    {
+        if (node->tokenCount < 0)
+            node->tokenCount = TokenEstimator::estimate(node->content);
+        path.push_back(node);
+    }
+    std::reverse(path.begin(), path.end());
+    omitted = 0;
+    if (path.empty())
+        return {};
+
+    size_t first = path.size();
+    int used = path[0]->tokenCount + TokenEstimator::MESSAGE_OVERHEAD;
+    while (first > 1)
+    {
+        int cost = path[first - 1]->tokenCount + TokenEstimator::MESSAGE_OVERHEAD;
+        if (budget > 0 && path.size() - first >= MIN_RECENT_MESSAGES && used + cost > budget)
+            break;
+        used += cost;
+        first--;
+    }
+    // Do not let the truncated history open with an orphaned assistant reply
+    if (first > 1)
+        while (path.size() - first > MIN_RECENT_MESSAGES && path[first]->role == ConversationNode::ROLE_ASSISTANT)
+            first++;
+
+    omitted = first - 1;
+    path.erase(path.begin() + 1, path.begin() + first);
+    return path;
+}
+
+// Concatenates the per-node cached message fragments into one preallocated
+// buffer so historical messages are not re-escaped on every turn.
+std::string AI::buildRequestBody(const nlohmann::json &parameters, const std::vector<ConversationNode *> &context, size_t omitted)
+{
+    static const std::string roleString[3] = {"user", "assistant", "system"};
+
+    std::string head = parameters.dump();
+    head.pop_back();
+    head += ",\"messages\":[";
+    // The note on omitted history goes into the leading system prompt: some APIs reject a system message
+    // anywhere but first
+    std::string rootFragment;
+    if (omitted)
+        rootFragment = nlohmann::json{{"role", roleString[context[0]->role]},
+                                      {"content", context[0]->content + "\n（已省略较早的 " + std::to_string(omitted) + " 条消息）"}}
+                           .dump();
+
+    size_t length = head.size() + rootFragment.size() + context.size() + 2;
+    for (ConversationNode *node : context)
+    {
+        if (node->requestFragment.empty())
+            node->requestFragment = nlohmann::json{{"role", roleString[node->role]},
+                                                   {"content", node->content}}
+                                        .dump();
+        length += node->requestFragment.size();
+    }
+
+    std::string body;
+    body.reserve(length);
+    body += head;
+    for (size_t i = 0; i < context.size(); i++)
+    {
+        if (i > 0)
+            body += ',';
+        body += i == 0 && omitted ? rootFragment : context[i]->requestFragment;
+    }
+    body += "]}";
+    return body;
+}
+
 void AI::addNode(ConversationNode::ROLE role, std::string content)
 {
     std::unique_lock<std::shared_mutex> stateLock(stateMutex);
@@ -80,9 +169,10 @@ void AI::addNode(ConversationNode::ROLE role, std::string content)
     if (parent)
         parent->childIds.push_back(nodeId);
     nodeMap[nodeId] = std::make_unique<ConversationNode>(nodeId, role, content, currentNodeId);
+    nodeMap[nodeId]->tokenCount = TokenEstimator::estimate(content);
     currentNodeId = nodeId;
     stateLock.unlock();
-    saveConversation();
+    saveNode(nodeId);
 }
 
 bool AI::deleteNode(const std::string &nodeId)
@@ -157,11 +247,26 @@ void AI::saveConversation()
     }
 }
 
+void AI::saveNode(const std::string &nodeId)
+{
+    std::shared_lock<std::shared_mutex> stateLock(stateMutex);
+    ConversationNode *node = findNode(nodeId);
+    if (node && !conversationId.empty())
+        conversationManager.saveNode(conversationId, *node);
+}
+
 std::vector<ConversationInfo> AI::getConversationList()
 {
     std::lock_guard<std::mutex> conversationLock(conversationMutex);
     return conversationManager.getConversationList();
 }
+RESULT AI::getConversationPage(size_t count, int64_t beforeUpdatedAt, const std::string &beforeId)
+{
+    return conversationManager.getConversationPage(count, beforeUpdatedAt, beforeId);
+}
+int AI::subscribeConversations(ConversationChangeCallback callback) { return conversationManager.subscribeConversations(callback); }
+void AI::unsubscribeConversations(int subscriptionId) { conversationManager.unsubscribeConversations(subscriptionId); }
+PROFILER *AI::getDatabaseProfiler() { return conversationManager.getProfiler(); }
 
 void AI::createConversation(const std::string &title)
 {
@@ -224,69 +329,226 @@ void AI::updateConversationTitle(const std::string &conversationId, const std::s
     conversationManager.updateConversationTitle(conversationId, title);
 }
 
+std::vector<SearchResult> AI::searchConversations(const std::string &query, size_t limit)
+{
+    std::lock_guard<std::mutex> conversationLock(conversationMutex);
+    return conversationManager.searchConversations(query, limit);
+}
+
 void AI::setSettings(const std::string &apiKey, const std::string &baseUrl,
                      const std::string &model, int maxTokens,
-                     double temperature, double topP, std::string systemPrompt)
+                     double temperature, double topP, std::string systemPrompt,
+                     int contextTokens)
 {
     std::lock_guard<std::mutex> settingsLock(settingsMutex);
     this->apiKey = apiKey, this->baseUrl = baseUrl;
     this->model = model, this->maxTokens = maxTokens;
     this->temperature = temperature, this->topP = topP, this->systemPrompt = systemPrompt;
-    conversationManager.saveApiSettings(apiKey, baseUrl, model, maxTokens, temperature, topP, systemPrompt);
+    this->contextTokens = contextTokens;
+    conversationManager.saveApiSettings(apiKey, baseUrl, model, maxTokens, temperature, topP, systemPrompt, contextTokens);
 }
 SettingsResponse AI::getSettings() const
 {
     std::lock_guard<std::mutex> settingsLock(settingsMutex);
     return SettingsResponse(apiKey, baseUrl,
                             model, maxTokens,
-                            temperature, topP, systemPrompt);
+                            temperature, topP, systemPrompt,
+                            contextTokens);
 }
 
 std::string AI::generateResponse(AIStreamCallback streamCallback)
+{
+    Generation generation = [this]
+    {
+        std::shared_lock<std::shared_mutex> stateLock(stateMutex);
+        return generations.begin(conversationId, currentNodeId);
+    }();
+    try
+    {
+        auto reply = std::make_shared<std::promise<std::string>>();
+        std::future<std::string> response = reply->get_future();
+        generate(generation, getEndpoint(), streamCallback, [reply](const std::string &content, const std::string &error)
+                 {
+                     if (error.empty())
+                         reply->set_value(content);
+                     else
+                         reply->set_exception(std::make_exception_ptr(std::runtime_error(error))); });
+        std::string content = response.get();
+        generations.end(generation.requestId);
+        return content;
+    }
+    catch (...)
+    {
+        generations.end(generation.requestId);
+        throw;
+    }
+}
+
+void AI::postGeneration(const Generation &generation, const Endpoint &endpoint,
+                        AIStreamCallback streamCallback, AIGenerationDoneCallback doneCallback)
+{
+    // The worker only builds the request, which may read another conversation; the reply streams in on the FetchEngine
+    generations.post([this, generation, endpoint, streamCallback, doneCallback]()
+                     {
+                         AIReplyCallback done = [this, generation, doneCallback](const std::string &response, const std::string &error)
+                         {
+                             generations.end(generation.requestId);
+                             doneCallback(generation.requestId, response, error);
+                         };
+                         try
+                         {
+                             generate(generation, endpoint, streamCallback, done);
+                         }
+                         catch (const std::exception &e)
+                         {
+                             done("", e.what());
+                         } });
+}
+
+std::string AI::startGeneration(const std::string &conversationId, const std::string &parentNodeId,
+                                AIGenerationStreamCallback streamCallback, AIGenerationDoneCallback doneCallback)
+{
+    Generation generation = generations.begin(conversationId, parentNodeId);
+    std::string requestId = generation.requestId;
+    postGeneration(generation, getEndpoint(), [streamCallback, requestId](const std::string &messageDelta)
+                   { streamCallback(requestId, messageDelta); }, doneCallback);
+    return requestId;
+}
+
+std::vector<std::string> AI::fanOut(const std::vector<Endpoint> &endpoints, bool race,
+                                    AIGenerationStreamCallback streamCallback, AIGenerationDoneCallback doneCallback)
+{
+    ASSERT(!endpoints.empty());
+    std::vector<Generation> group;
+    {
+        std::shared_lock<std::shared_mutex> stateLock(stateMutex);
+        ConversationNode *userNode = findNode(currentNodeId);
+        ASSERT(userNode != nullptr && userNode->role == ConversationNode::ROLE_USER);
+        for (size_t i = 0; i < endpoints.size(); i++)
+            group.push_back(generations.begin(conversationId, currentNodeId));
+    }
+
+    Endpoint defaults = getEndpoint();
+    auto winnerChosen = std::make_shared<std::atomic<bool>>(false);
+    std::vector<std::string> requestIds;
+    for (size_t i = 0; i < endpoints.size(); i++)
+    {
+        Endpoint endpoint = endpoints[i];
+        if (endpoint.apiKey.empty())
+            endpoint.apiKey = defaults.apiKey;
+        if (endpoint.baseUrl.empty())
+            endpoint.baseUrl = defaults.baseUrl;
+        if (endpoint.modelName.empty())
+            endpoint.modelName = defaults.modelName;
+
+        std::string requestId = group[i].requestId;
+        AIStreamCallback raceCallback = [streamCallback, requestId, race, group, winnerChosen](const std::string &messageDelta)
+        {
+            // The first endpoint to produce tokens wins, the others are stopped before writing a node
+            if (race && !winnerChosen->exchange(true))
+                for (const auto &other : group)
+                    if (other.requestId != requestId)
+                        other.cancelled->store(true);
+            streamCallback(requestId, messageDelta);
+        };
+        postGeneration(group[i], endpoint, raceCallback, doneCallback);
+        requestIds.push_back(requestId);
+    }
+    return requestIds;
+}
+
+// Mirrors a streamed node into the loaded conversation (if it is the
+// generation's target) and persists it.
+void AI::storeGeneratedNode(const Generation &generation, const ConversationNode &node)
+{
+    std::unique_lock<std::shared_mutex> stateLock(stateMutex);
+    if (generation.conversationId == conversationId)
+    {
+        ConversationNode *existing = findNode(node.id);
+        if (existing)
+        {
+            existing->content = node.content;
+            existing->stopReason = node.stopReason;
+            existing->tokenCount = node.tokenCount;
+            existing->streaming = node.streaming;
+            existing->requestFragment.clear();
+        }
+        else if (ConversationNode *parent = findNode(node.parentId))
+        {
+            parent->childIds.push_back(node.id);
+            nodeMap[node.id] = std::make_unique<ConversationNode>(node);
+            if (currentNodeId == node.parentId)
+                currentNodeId = node.id;
+        }
+    }
+    stateLock.unlock();
+    conversationManager.saveNode(generation.conversationId, node);
+}
+
+Endpoint AI::getEndpoint() const
+{
+    std::lock_guard<std::mutex> settingsLock(settingsMutex);
+    return Endpoint(apiKey, baseUrl, model);
+}
+
+void AI::generate(const Generation &generation, const Endpoint &endpoint, AIStreamCallback streamCallback, AIReplyCallback done)
 {
     nlohmann::json requestJson;
+    int budget;
     {
         std::lock_guard<std::mutex> settingsLock(settingsMutex);
-        requestJson["model"] = model;
+        budget = contextTokens;
         requestJson["max_tokens"] = maxTokens;
         requestJson["temperature"] = temperature;
         requestJson["top_p"] = topP;
     }
+    requestJson["model"] = endpoint.modelName;
 
     requestJson["stream"] = true;
 
-    const std::string_view roleString[3] = {"user", "assistant", "system"};
-    nlohmann::json messagesArray = nlohmann::json::array();
-
+    std::string requestBody;
     {
-        std::shared_lock<std::shared_mutex> stateLock(stateMutex);
-        for (const auto &msg : getPathFromRoot(currentNodeId))
-            messagesArray.push_back({{"role", roleString[msg.role]},
-                                     {"content", msg.content}});
+        std::unique_lock<std::shared_mutex> stateLock(stateMutex);
+        size_t omitted;
+        if (generation.conversationId == conversationId)
+        {
+            std::vector<ConversationNode *> context = buildContext(nodeMap, generation.parentNodeId, budget, omitted);
+            ASSERT(!context.empty());
+            requestBody = buildRequestBody(requestJson, context, omitted);
+        }
+        else
+        {
+            stateLock.unlock();
+            // The target conversation is not loaded, read it without replacing the current one
+            std::unordered_map<std::string, std::unique_ptr<ConversationNode>> otherNodeMap;
+            std::string otherRootNodeId, otherLeafNodeId;
+            conversationManager.loadConversation(generation.conversationId, otherNodeMap, otherRootNodeId, otherLeafNodeId);
+            std::vector<ConversationNode *> context = buildContext(otherNodeMap, generation.parentNodeId, budget, omitted);
+            ASSERT(!context.empty());
+            requestBody = buildRequestBody(requestJson, context, omitted);
+        }
     }
 
-    requestJson["messages"] = messagesArray;
-
-    std::string fullAssistantResponse;
-    std::mutex responseMutex;
-    bool wasCancelled = false;
-    bool responseStarted = false;
-    std::string assistantNodeId;
-    ConversationNode::STOP_REASON finalStopReason = ConversationNode::STOP_REASON_NONE;
-
-    std::shared_ptr<std::atomic<bool>> cancellationToken;
+    // Shared by the stream and completion callbacks, which outlive this call
+    struct Reply
     {
-        std::lock_guard<std::mutex> cancelLock(requestCancelMutex);
-        currentRequestCancelled = std::make_shared<std::atomic<bool>>(false);
-        cancellationToken = currentRequestCancelled;
-    }
+        ConversationNode assistantNode;
+        bool wasCancelled = false;
+        bool responseStarted = false;
+    };
+    auto reply = std::make_shared<Reply>(Reply{ConversationNode(generation.requestId, ConversationNode::ROLE_ASSISTANT, "", generation.parentNodeId)});
+    reply->assistantNode.streaming = true;
 
-    StreamCallback packedStreamCallback = [&fullAssistantResponse, &responseMutex, &wasCancelled, &responseStarted, &assistantNodeId, &finalStopReason, cancellationToken, streamCallback, this](const std::string &chunk)
+    std::shared_ptr<LIFETIME> lifetime = this->lifetime;
+    StreamCallback packedStreamCallback = [reply, generation, streamCallback, lifetime, this](const std::string &chunk)
     {
-        if (cancellationToken->load())
+        std::lock_guard<std::mutex> lifetimeLock(lifetime->mutex);
+        if (!lifetime->alive)
+            return;
+        ConversationNode &assistantNode = reply->assistantNode;
+        if (generation.cancelled->load())
         {
-            wasCancelled = true;
-            finalStopReason = ConversationNode::STOP_REASON_USER_STOPPED;
+            reply->wasCancelled = true;
             return;
         }
 
@@ -300,13 +562,13 @@ std::string AI::generateResponse(AIStreamCallback streamCallback)
         {
             std::string finishReason = choice["finish_reason"];
             if (finishReason == "stop")
-                finalStopReason = ConversationNode::STOP_REASON_STOP;
+                assistantNode.stopReason = ConversationNode::STOP_REASON_STOP;
             else if (finishReason == "length")
-                finalStopReason = ConversationNode::STOP_REASON_LENGTH;
+                assistantNode.stopReason = ConversationNode::STOP_REASON_LENGTH;
             else if (finishReason == "content_filter")
-                finalStopReason = ConversationNode::STOP_REASON_CONTENT_FILTER;
+                assistantNode.stopReason = ConversationNode::STOP_REASON_CONTENT_FILTER;
             else
-                finalStopReason = ConversationNode::STOP_REASON_ERROR;
+                assistantNode.stopReason = ConversationNode::STOP_REASON_ERROR;
         }
 
         std::string content = "";
@@ -316,103 +578,88 @@ std::string AI::generateResponse(AIStreamCallback streamCallback)
             content += choice["delta"]["content"];
         if (content != "")
         {
-            {
-                std::lock_guard<std::mutex> lock(responseMutex);
-                fullAssistantResponse += content;
-
-                if (!responseStarted && !content.empty())
-                {
-                    responseStarted = true;
-                    std::unique_lock<std::shared_mutex> stateLock(stateMutex);
-                    assistantNodeId = strUtils::randomId();
-                    ConversationNode *parent = findNode(currentNodeId);
-                    if (parent)
-                        parent->childIds.push_back(assistantNodeId);
-                    nodeMap[assistantNodeId] = std::make_unique<ConversationNode>(assistantNodeId, ConversationNode::ROLE_ASSISTANT, fullAssistantResponse, currentNodeId);
-                    currentNodeId = assistantNodeId;
-                    stateLock.unlock();
-                    saveConversation();
-                }
-                else if (responseStarted && !assistantNodeId.empty())
-                {
-                    std::unique_lock<std::shared_mutex> stateLock(stateMutex);
-                    ConversationNode *assistantNode = findNode(assistantNodeId);
-                    if (assistantNode)
-                        assistantNode->content = fullAssistantResponse;
-                    stateLock.unlock();
-                    saveConversation();
-                }
-            }
+            reply->responseStarted = true;
+            assistantNode.content += content;
+            storeGeneratedNode(generation, assistantNode);
             streamCallback(content);
         }
     };
 
-    std::string currentApiKey, currentBaseUrl;
-    {
-        std::lock_guard<std::mutex> settingsLock(settingsMutex);
-        currentApiKey = apiKey;
-        currentBaseUrl = baseUrl;
-    }
-
-    Response response = Fetch::fetch(currentBaseUrl + "chat/completions",
-                                     FetchOptions("POST",
-                                                  {{"Content-Type", "application/json"},
-                                                   {"Authorization", "Bearer " + currentApiKey},
-                                                   {"Accept", "text/event-stream"}},
-                                                  requestJson.dump(),
-                                                  true,
-                                                  packedStreamCallback,
-                                                  0,
-                                                  cancellationToken));
-    {
-        std::lock_guard<std::mutex> cancelLock(requestCancelMutex);
-        currentRequestCancelled = nullptr;
-    }
-    if (wasCancelled || cancellationToken->load())
-    {
-        std::lock_guard<std::mutex> lock(responseMutex);
-        if (responseStarted && !assistantNodeId.empty())
-        {
-            std::unique_lock<std::shared_mutex> stateLock(stateMutex);
-            ConversationNode *assistantNode = findNode(assistantNodeId);
-            if (assistantNode)
-            {
-                assistantNode->stopReason = ConversationNode::STOP_REASON_USER_STOPPED;
-            }
-            stateLock.unlock();
-            saveConversation();
-        }
-        return fullAssistantResponse;
-    }
-    if (!response.isOk())
-        THROW_NETWORK_ERROR(response.status);
-
-    {
-        std::lock_guard<std::mutex> lock(responseMutex);
-        if (!responseStarted && !fullAssistantResponse.empty())
-        {
-            addNode(ConversationNode::ROLE_ASSISTANT, fullAssistantResponse);
-        }
-        else if (responseStarted && !assistantNodeId.empty() && finalStopReason != ConversationNode::STOP_REASON_NONE)
-        {
-            std::unique_lock<std::shared_mutex> stateLock(stateMutex);
-            ConversationNode *assistantNode = findNode(assistantNodeId);
-            if (assistantNode)
-            {
-                assistantNode->stopReason = finalStopReason;
-            }
-            stateLock.unlock();
-            saveConversation();
-        }
-        return fullAssistantResponse;
-    }
+    Fetch::fetchAsync(endpoint.baseUrl + "chat/completions",
+                      FetchOptions("POST",
+                                   {{"Content-Type", "application/json"},
+                                    {"Authorization", "Bearer " + endpoint.apiKey},
+                                    {"Accept", "text/event-stream"}},
+                                   std::move(requestBody),
+                                   true,
+                                   packedStreamCallback,
+                                   0,
+                                   generation.cancelled),
+                      [reply, generation, done, lifetime, this](Response response, const std::string &error)
+                      {
+                          std::lock_guard<std::mutex> lifetimeLock(lifetime->mutex);
+                          if (!lifetime->alive)
+                              return;
+                          ConversationNode &assistantNode = reply->assistantNode;
+                          try
+                          {
+                              if (reply->wasCancelled || generation.cancelled->load())
+                              {
+                                  if (reply->responseStarted)
+                                  {
+                                      assistantNode.stopReason = ConversationNode::STOP_REASON_USER_STOPPED;
+                                      assistantNode.tokenCount = TokenEstimator::estimate(assistantNode.content);
+                                      assistantNode.streaming = false;
+                                      storeGeneratedNode(generation, assistantNode);
+                                  }
+                                  done(assistantNode.content, "");
+                                  return;
+                              }
+                              if (!error.empty())
+                                  throw std::runtime_error(error);
+                              if (!response.isOk())
+                                  THROW_NETWORK_ERROR(response.status);
+
+                              if (reply->responseStarted)
+                              {
+                                  assistantNode.tokenCount = TokenEstimator::estimate(assistantNode.content);
+                                  assistantNode.streaming = false;
+                                  storeGeneratedNode(generation, assistantNode);
+                              }
+                          }
+                          catch (const std::exception &e)
+                          {
+                              // Keep what arrived before the failure, marked as an error
+                              if (reply->responseStarted && assistantNode.streaming)
+                              {
+                                  assistantNode.stopReason = ConversationNode::STOP_REASON_ERROR;
+                                  assistantNode.tokenCount = TokenEstimator::estimate(assistantNode.content);
+                                  assistantNode.streaming = false;
+                                  try
+                                  {
+                                      storeGeneratedNode(generation, assistantNode);
+                                  }
+                                  catch (const std::exception &)
+                                  {
+                                  }
+                              }
+                              done("", e.what());
+                              return;
+                          }
+                          done(assistantNode.content, ""); });
 }
 
 void AI::stopGeneration()
 {
-    std::lock_guard<std::mutex> cancelLock(requestCancelMutex);
-    if (currentRequestCancelled)
-        currentRequestCancelled->store(true);
+    generations.cancelAll();
+}
+bool AI::stopGeneration(const std::string &requestId)
+{
+    return generations.cancel(requestId);
+}
+std::vector<Generation> AI::getGenerations() const
+{
+    return generations.getGenerations();
 }
 
 std::vector<std::string> AI::getModels()
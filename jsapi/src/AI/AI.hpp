@@ -31,6 +31,8 @@
 #include "ConversationInfo.hpp"
 #include "ConversationManager.hpp"
 #include "SettingsResponse.hpp"
+#include "GenerationManager.hpp"
+#include "Endpoint.hpp"
 
 class AI
 {
@@ -42,6 +44,7 @@ private:
     double temperature = 0.7;
     double topP = 1.0;
     std::string systemPrompt = "你是一个有用的助手。请尽力回答问题。请不要使用任何 Markdown 语法或者表情符号等特殊字符来格式化回答。";
+    int contextTokens = 0; // <= 0 sends the whole path, a budget applies only once the user saves one
 
     std::unordered_map<std::string, std::unique_ptr<ConversationNode>> nodeMap;
     std::string currentNodeId, rootNodeId;
@@ -51,16 +54,38 @@ private:
     mutable std::mutex settingsMutex;
     mutable std::mutex conversationMutex;
 
-    std::shared_ptr<std::atomic<bool>> currentRequestCancelled;
-    std::mutex requestCancelMutex;
+    // Replies go on streaming on the FetchEngine after the AI that started them is destroyed. Their callbacks
+    // share this and only touch the AI while holding its mutex with alive still set.
+    struct LIFETIME
+    {
+        std::mutex mutex;
+        bool alive = true;
+    };
+    std::shared_ptr<LIFETIME> lifetime = std::make_shared<LIFETIME>();
 
+    static ConversationNode *findNode(const std::unordered_map<std::string, std::unique_ptr<ConversationNode>> &nodes, const std::string &nodeId);
     ConversationNode *findNode(const std::string &nodeId);
     std::vector<ConversationNode> getPathFromRoot(const std::string &nodeId);
+    std::vector<ConversationNode *> buildContext(const std::unordered_map<std::string, std::unique_ptr<ConversationNode>> &nodes,
+                                                 const std::string &nodeId, int budget, size_t &omitted);
+    std::string buildRequestBody(const nlohmann::json &parameters, const std::vector<ConversationNode *> &context, size_t omitted);
 
     void saveConversation();
+    void saveNode(const std::string &nodeId);
+
+    Endpoint getEndpoint() const;
+    // Builds the request on the calling thread, then streams the reply on the FetchEngine; done runs once, on its callback thread
+    void generate(const Generation &generation, const Endpoint &endpoint, AIStreamCallback streamCallback, AIReplyCallback done);
+    void postGeneration(const Generation &generation, const Endpoint &endpoint,
+                        AIStreamCallback streamCallback, AIGenerationDoneCallback doneCallback);
+    void storeGeneratedNode(const Generation &generation, const ConversationNode &node);
+
+    // Declared last so its workers are joined before the state they use is destroyed
+    GenerationManager generations;
 
 public:
     AI();
+    ~AI();
 
     void addNode(ConversationNode::ROLE role, std::string content);
     bool deleteNode(const std::string &nodeId);
@@ -73,18 +98,30 @@ public:
     std::string getConversationId() const;
 
     std::vector<ConversationInfo> getConversationList();
+    RESULT getConversationPage(size_t count, int64_t beforeUpdatedAt, const std::string &beforeId);
+    int subscribeConversations(ConversationChangeCallback callback);
+    void unsubscribeConversations(int subscriptionId);
+    PROFILER *getDatabaseProfiler();
     void createConversation(const std::string &title);
     void loadConversation(const std::string &conversationId);
     void deleteConversation(const std::string &conversationId);
     void updateConversationTitle(const std::string &conversationId, const std::string &title);
+    std::vector<SearchResult> searchConversations(const std::string &query, size_t limit);
 
     void setSettings(const std::string &apiKey, const std::string &baseUrl,
                      const std::string &model, int maxTokens,
-                     double temperature, double topP, std::string systemPrompt);
+                     double temperature, double topP, std::string systemPrompt,
+                     int contextTokens);
     SettingsResponse getSettings() const;
 
     std::string generateResponse(AIStreamCallback streamCallback);
+    std::string startGeneration(const std::string &conversationId, const std::string &parentNodeId,
+                                AIGenerationStreamCallback streamCallback, AIGenerationDoneCallback doneCallback);
+    std::vector<std::string> fanOut(const std::vector<Endpoint> &endpoints, bool race,
+                                    AIGenerationStreamCallback streamCallback, AIGenerationDoneCallback doneCallback);
     void stopGeneration();
+    bool stopGeneration(const std::string &requestId);
+    std::vector<Generation> getGenerations() const;
     std::vector<std::string> getModels();
     float getUserBalance();
 };
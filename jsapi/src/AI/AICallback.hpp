@@ -19,5 +19,13 @@
 
 #include <string>
 #include <functional>
+#include <vector>
+#include "ConversationInfo.hpp"
 
 using AIStreamCallback = std::function<void(const std::string &messageDelta)>;
+using AIGenerationStreamCallback = std::function<void(const std::string &requestId, const std::string &messageDelta)>;
+// error is empty when the reply completed or was stopped
+using AIReplyCallback = std::function<void(const std::string &response, const std::string &error)>;
+using AIGenerationDoneCallback = std::function<void(const std::string &requestId, const std::string &response, const std::string &error)>;
+// changed holds the conversations created or modified by one transaction; deleted rows cannot be looked up any more, so removed only flags them
+using ConversationChangeCallback = std::function<void(const std::vector<ConversationInfo> &changed, bool removed)>;
@@ -19,15 +19,54 @@
 #include "strUtils.hpp"
 #include <chrono>
 #include <algorithm>
+#include <iostream>
 #include <stdexcept>
+#include <unordered_set>
 
-ConversationManager::ConversationManager() : database("/userdisk/database/langningchen-ai.db")
+// token_count is NULL until estimated, the -1 ConversationNode uses in memory is never stored
+static VALUE tokenCountValue(int tokenCount) { return tokenCount < 0 ? VALUE(nullptr) : toValue(tokenCount); }
+
+// Column names of table, empty when it does not exist yet
+static std::unordered_set<std::string> tableColumns(DATABASE &database, const std::string &table)
 {
+    std::unordered_set<std::string> columns;
+    for (const auto &row : database.query("SELECT name FROM pragma_table_info(?)").bind(table).execute())
+        columns.insert(std::string(row.getText(0)));
+    return columns;
+}
+
+ConversationManager::ConversationManager(const std::string &filePath, const DatabaseOptions &options) : database(filePath, options)
+{
+    database.migrate(1, [this]
+                     {
+                         // Tables created before these columns existed; fresh ones get them from the definitions below
+                         auto nodeColumns = tableColumns(database, "conversation_nodes");
+                         if (!nodeColumns.empty() && !nodeColumns.count("token_count"))
+                             database.query("ALTER TABLE conversation_nodes ADD COLUMN token_count INTEGER").execute();
+                         else if (nodeColumns.count("token_count"))
+                             // Rows written while in-progress nodes stored -1
+                             database.update("conversation_nodes")
+                                 .set("token_count", nullptr)
+                                 .where(WHERE::lt("token_count", 0))
+                                 .execute();
+                         auto settingsColumns = tableColumns(database, "api_settings");
+                         if (!settingsColumns.empty() && !settingsColumns.count("context_tokens"))
+                             database.query("ALTER TABLE api_settings ADD COLUMN context_tokens INTEGER").execute(); });
+    database.migrate(2, [this]
+                     {
+                         // The search index used to follow token_count, which is NULL on every row older than
+                         // that column. Without its triggers the index is rebuilt below, by streaming instead.
+                         auto nodeColumns = tableColumns(database, "conversation_nodes");
+                         if (!nodeColumns.empty() && !nodeColumns.count("streaming"))
+                             database.query("ALTER TABLE conversation_nodes ADD COLUMN streaming INTEGER NOT NULL DEFAULT 0").execute();
+                         for (const char *trigger : {"conversation_nodes_fts_index", "conversation_nodes_fts_unindex", "conversation_nodes_fts_reindex"})
+                             database.query(std::string("DROP TRIGGER IF EXISTS ") + trigger).execute(); });
     database.table("conversations")
         .column("id", TABLE::TEXT, TABLE::PRIMARY_KEY)
         .column("title", TABLE::TEXT, TABLE::NOT_NULL)
         .column("created_at", TABLE::INTEGER, TABLE::NOT_NULL)
         .column("updated_at", TABLE::INTEGER, TABLE::NOT_NULL)
+        .index({"updated_at"})
         .execute();
     database.table("conversation_nodes")
         .column("id", TABLE::TEXT, TABLE::PRIMARY_KEY)
@@ -37,7 +76,70 @@ ConversationManager::ConversationManager() : database("/userdisk/database/langni
         .column("content", TABLE::TEXT, TABLE::NOT_NULL)
         .column("stop_reason", TABLE::INTEGER, TABLE::NOT_NULL)
         .column("created_at", TABLE::INTEGER, TABLE::NOT_NULL)
+        .column("token_count", TABLE::INTEGER)
+        .column("streaming", TABLE::INTEGER, TABLE::NOT_NULL | TABLE::DEFAULT, "0")
+        .index({"conversation_id"})
+        .index({"streaming"}, 0, "streaming = 1")
         .execute();
+    // No generation outlives the process: replies cut off by an exit are kept as they are
+    database.query("UPDATE conversation_nodes SET streaming = 0 WHERE streaming = 1").execute();
+    try
+    {
+        // External-content FTS index over the finished nodes of conversation_nodes, kept in sync by triggers.
+        // A reply still streaming in stays out until it is final, so its growing content is not re-tokenized on
+        // every chunk. Every trigger tests the same condition: 'delete' must only ever be issued for a row that
+        // was indexed, with the content it was indexed with.
+        bool ftsExists = !database.query("SELECT name FROM sqlite_master WHERE type='table' AND name=?")
+                              .bind("conversation_nodes_fts")
+                              .execute()
+                              .empty();
+        bool legacyTriggers = !database.query("SELECT name FROM sqlite_master WHERE type='trigger' AND name=?")
+                                   .bind("conversation_nodes_fts_insert")
+                                   .execute()
+                                   .empty();
+        // Also missing after a migration dropped them to change what is indexed
+        bool triggersExist = !database.query("SELECT name FROM sqlite_master WHERE type='trigger' AND name=?")
+                                  .bind("conversation_nodes_fts_index")
+                                  .execute()
+                                  .empty();
+        auto transaction = database.transaction();
+        database.query("CREATE VIRTUAL TABLE IF NOT EXISTS conversation_nodes_fts USING fts5("
+                       "content, content='conversation_nodes', content_rowid='rowid', tokenize='trigram')")
+            .execute();
+        if (legacyTriggers)
+            for (const char *trigger : {"conversation_nodes_fts_insert", "conversation_nodes_fts_delete", "conversation_nodes_fts_update"})
+                database.query(std::string("DROP TRIGGER IF EXISTS ") + trigger).execute();
+        database.query("CREATE TRIGGER IF NOT EXISTS conversation_nodes_fts_index AFTER INSERT ON conversation_nodes "
+                       "WHEN new.streaming = 0 BEGIN "
+                       "INSERT INTO conversation_nodes_fts(rowid, content) VALUES (new.rowid, new.content); END")
+            .execute();
+        database.query("CREATE TRIGGER IF NOT EXISTS conversation_nodes_fts_unindex AFTER DELETE ON conversation_nodes "
+                       "WHEN old.streaming = 0 BEGIN "
+                       "INSERT INTO conversation_nodes_fts(conversation_nodes_fts, rowid, content) VALUES ('delete', old.rowid, old.content); END")
+            .execute();
+        database.query("CREATE TRIGGER IF NOT EXISTS conversation_nodes_fts_reindex AFTER UPDATE OF content, streaming ON conversation_nodes "
+                       "WHEN old.content IS NOT new.content OR old.streaming != new.streaming BEGIN "
+                       "INSERT INTO conversation_nodes_fts(conversation_nodes_fts, rowid, content) "
+                       "SELECT 'delete', old.rowid, old.content WHERE old.streaming = 0; "
+                       "INSERT INTO conversation_nodes_fts(rowid, content) "
+                       "SELECT new.rowid, new.content WHERE new.streaming = 0; END")
+            .execute();
+        // 'rebuild' would index every row, the unfinished ones included
+        if (!ftsExists || !triggersExist)
+        {
+            database.query("INSERT INTO conversation_nodes_fts(conversation_nodes_fts) VALUES ('delete-all')").execute();
+            database.query("INSERT INTO conversation_nodes_fts(rowid, content) "
+                           "SELECT rowid, content FROM conversation_nodes WHERE streaming = 0")
+                .execute();
+        }
+        transaction.commit();
+        ftsAvailable = true;
+    }
+    catch (const std::exception &e)
+    {
+        // SQLite built without FTS5 or the trigram tokenizer, fall back to scanning
+        ftsAvailable = false;
+    }
     database.table("api_settings")
         .column("id", TABLE::TEXT, TABLE::PRIMARY_KEY)
         .column("api_key", TABLE::TEXT, TABLE::NOT_NULL)
@@ -47,12 +149,12 @@ ConversationManager::ConversationManager() : database("/userdisk/database/langni
         .column("temperature", TABLE::REAL, TABLE::NOT_NULL)
         .column("top_p", TABLE::REAL, TABLE::NOT_NULL)
         .column("system_prompt", TABLE::TEXT, TABLE::NOT_NULL)
+        .column("context_tokens", TABLE::INTEGER)
         .execute();
 }
 
 std::vector<ConversationInfo> ConversationManager::getConversationList()
 {
-    std::lock_guard<std::mutex> lock(dbMutex);
     std::vector<ConversationInfo> conversations;
     auto results = database.select("conversations")
                        .select("id")
@@ -63,13 +165,55 @@ std::vector<ConversationInfo> ConversationManager::getConversationList()
                        .execute();
     for (const auto &row : results)
         conversations.push_back(ConversationInfo(
-            row.at("id"),
-            row.at("title"),
-            std::stoll(row.at("created_at")),
-            std::stoll(row.at("updated_at"))));
+            std::string(row.getText(0)),
+            std::string(row.getText(1)),
+            row.getInt(2),
+            row.getInt(3)));
     return conversations;
 }
 
+RESULT ConversationManager::getConversationPage(size_t count, int64_t beforeUpdatedAt, const std::string &beforeId)
+{
+    // Keyset pagination: each page starts right after the last row of the previous one, however the rows
+    // before it changed in between
+    return database.read("SELECT id, title, created_at AS createdAt, updated_at AS updatedAt "
+                         "FROM conversations WHERE (updated_at, id) < (?, ?) "
+                         "ORDER BY updated_at DESC, id DESC LIMIT ?")
+        .bind(beforeUpdatedAt)
+        .bind(beforeId)
+        .bind(count)
+        .execute();
+}
+int ConversationManager::subscribeConversations(ConversationChangeCallback callback)
+{
+    // Runs on the writing thread right after its commit, possibly while it still holds dbMutex
+    return database.subscribe({"conversations"}, [this, callback](const std::vector<CHANGE> &changes)
+                              {
+                                  std::vector<int64_t> rowIds;
+                                  bool removed = false;
+                                  for (const auto &change : changes)
+                                      if (change.operation == SQLITE_DELETE)
+                                          removed = true;
+                                      else
+                                          rowIds.push_back(change.rowId);
+                                  std::vector<ConversationInfo> changed;
+                                  if (!rowIds.empty())
+                                      for (const auto &row : database.select("conversations")
+                                                                 .select("id")
+                                                                 .select("title")
+                                                                 .select("created_at")
+                                                                 .select("updated_at")
+                                                                 .where(WHERE::in("rowid", rowIds))
+                                                                 .execute())
+                                          changed.push_back(ConversationInfo(
+                                              std::string(row.getText(0)),
+                                              std::string(row.getText(1)),
+                                              row.getInt(2),
+                                              row.getInt(3)));
+                                  callback(changed, removed); });
+}
+void ConversationManager::unsubscribeConversations(int subscriptionId) { database.unsubscribe(subscriptionId); }
+PROFILER *ConversationManager::getProfiler() { return database.enableProfiler(); }
 void ConversationManager::createConversation(const std::string &title, std::string &outConversationId)
 {
     std::lock_guard<std::mutex> lock(dbMutex);
@@ -87,12 +231,14 @@ void ConversationManager::createConversation(const std::string &title, std::stri
 void ConversationManager::deleteConversation(const std::string &conversationId)
 {
     std::lock_guard<std::mutex> lock(dbMutex);
+    auto transaction = database.transaction();
     database.remove("conversation_nodes")
         .where("conversation_id", conversationId)
         .execute();
     database.remove("conversations")
         .where("id", conversationId)
         .execute();
+    transaction.commit();
 }
 void ConversationManager::updateConversationTitle(const std::string &conversationId, const std::string &title)
 {
@@ -111,41 +257,43 @@ void ConversationManager::saveConversation(const std::string &conversationId,
                            std::chrono::system_clock::now().time_since_epoch())
                            .count();
 
-    database.update("conversations")
-        .set("updated_at", currentTime)
-        .where("id", conversationId)
-        .execute();
+    auto transaction = database.transaction();
+    touchConversation(conversationId, currentTime);
 
-    database.remove("conversation_nodes")
-        .where("conversation_id", conversationId)
-        .execute();
+    // Upserted in place rather than deleted and reinserted, so rowids stay stable and the FTS triggers only
+    // see nodes whose content actually changed
+    std::vector<std::string> removed;
+    for (const auto &row : database.select("conversation_nodes")
+                               .select("id")
+                               .where("conversation_id", conversationId)
+                               .execute())
+        if (nodeMap.find(std::string(row.getText(0))) == nodeMap.end())
+            removed.push_back(std::string(row.getText(0)));
+    if (!removed.empty())
+        database.remove("conversation_nodes")
+            .where(WHERE::in("id", removed))
+            .execute();
 
     for (const auto &pair : nodeMap)
-    {
-        const auto &node = pair.second;
-        if (!node)
-            continue;
-
-        database.insert("conversation_nodes")
-            .value("id", node->id)
-            .value("conversation_id", conversationId)
-            .value("parent_id", node->parentId)
-            .value("role", (int)node->role)
-            .value("content", node->content)
-            .value("stop_reason", (int)node->stopReason)
-            .value("created_at", currentTime)
-            .execute();
-    }
+        if (pair.second)
+            upsertNode(conversationId, *pair.second, currentTime);
+    transaction.commit();
 }
 void ConversationManager::loadConversation(const std::string &conversationId,
                                            std::unordered_map<std::string, std::unique_ptr<ConversationNode>> &nodeMap,
                                            std::string &rootNodeId, std::string &leafNodeId)
 {
-    std::lock_guard<std::mutex> lock(dbMutex);
     nodeMap.clear();
     rootNodeId.clear();
 
     auto nodeResults = database.select("conversation_nodes")
+                           .select("id")
+                           .select("parent_id")
+                           .select("role")
+                           .select("content")
+                           .select("stop_reason")
+                           .select("token_count")
+                           .select("streaming")
                            .where("conversation_id", conversationId)
                            .execute();
 
@@ -153,14 +301,17 @@ void ConversationManager::loadConversation(const std::string &conversationId,
 
     for (const auto &row : nodeResults)
     {
-        std::string nodeId = row.at("id");
-        std::string parentId = row.at("parent_id");
-        int role = std::stoi(row.at("role"));
-        std::string content = row.at("content");
-        int stopReason = row.count("stop_reason") ? std::stoi(row.at("stop_reason")) : 6; // Default to STOP_REASON_NONE
+        std::string nodeId(row.getText(0));
+        std::string parentId(row.getText(1));
+        int role = row.getInt(2);
+        std::string content(row.getText(3));
+        int stopReason = row.isNull(4) ? 6 : row.getInt(4); // Default to STOP_REASON_NONE
+        int tokenCount = row.isNull(5) ? -1 : row.getInt(5);
 
         nodeMap[nodeId] = std::make_unique<ConversationNode>(
             nodeId, static_cast<ConversationNode::ROLE>(role), content, parentId, static_cast<ConversationNode::STOP_REASON>(stopReason));
+        nodeMap[nodeId]->tokenCount = tokenCount;
+        nodeMap[nodeId]->streaming = row.getInt(6) != 0;
 
         if (!parentId.empty())
             parentToChildren[parentId].push_back(nodeId);
@@ -173,46 +324,253 @@ void ConversationManager::loadConversation(const std::string &conversationId,
             nodeMap[pair.first]->childIds = pair.second;
 
     leafNodeId = rootNodeId;
-    while (!nodeMap[leafNodeId]->childIds.empty())
+    while (!leafNodeId.empty() && !nodeMap[leafNodeId]->childIds.empty())
         leafNodeId = nodeMap[leafNodeId]->childIds.back();
 }
 
-void ConversationManager::saveApiSettings(const std::string &apiKey, const std::string &baseUrl,
-                                          const std::string &model, int maxTokens,
-                                          double temperature, double topP, const std::string &systemPrompt)
+// Unlike the settings, nodes are not handed to database.write(): callers read the conversation back or
+// report the reply as done once this returns, so it has to be committed by then, and a full write queue
+// must not drop it
+void ConversationManager::saveNode(const std::string &conversationId, const ConversationNode &node)
 {
     std::lock_guard<std::mutex> lock(dbMutex);
-    database.remove("api_settings").execute();
-    database.insert("api_settings")
-        .value("id", "default")
-        .value("api_key", apiKey)
-        .value("base_url", baseUrl)
-        .value("model", model)
-        .value("max_tokens", maxTokens)
-        .value("temperature", temperature)
-        .value("top_p", topP)
-        .value("system_prompt", systemPrompt)
+    auto currentTime = std::chrono::duration_cast<std::chrono::seconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count();
+
+    auto transaction = database.transaction();
+    touchConversation(conversationId, currentTime);
+
+    upsertNode(conversationId, node, currentTime);
+    transaction.commit();
+}
+void ConversationManager::touchConversation(const std::string &conversationId, int64_t currentTime)
+{
+    // Skipped when the second has not changed: every write of conversations is published to the
+    // change feed subscribers, and saveNode runs for each streamed chunk
+    database.update("conversations")
+        .set("updated_at", currentTime)
+        .where(WHERE::eq("id", conversationId) && WHERE::ne("updated_at", currentTime))
+        .execute();
+}
+void ConversationManager::upsertNode(const std::string &conversationId, const ConversationNode &node, int64_t currentTime)
+{
+    database.upsert("conversation_nodes")
+        .value("id", node.id)
+        .value("conversation_id", conversationId)
+        .value("parent_id", node.parentId)
+        .value("role", (int)node.role)
+        .value("content", node.content)
+        .value("stop_reason", (int)node.stopReason)
+        .value("created_at", currentTime)
+        .value("token_count", tokenCountValue(node.tokenCount))
+        .value("streaming", node.streaming ? 1 : 0)
+        .conflict("id")
+        .update("parent_id")
+        .update("content")
+        .update("stop_reason")
+        .update("token_count")
+        .update("streaming")
         .execute();
 }
 
+static const char SNIPPET_MATCH_BEGIN = '\x02';
+static const char SNIPPET_MATCH_END = '\x03';
+static const size_t SNIPPET_LENGTH = 48;
+
+struct SearchHitRow
+{
+    std::string nodeId;
+    std::string conversationId;
+    int role;
+    std::string title;
+    long long updatedAt;
+    std::string snippet;
+    double rank;
+};
+
+// Strips the match markers emitted by snippet() and records where they were
+static SearchHit makeHit(const std::string &nodeId, int role, const std::string &markedSnippet)
+{
+    std::string snippet;
+    std::vector<std::pair<size_t, size_t>> matches;
+    size_t matchStart = 0;
+    for (char ch : markedSnippet)
+        if (ch == SNIPPET_MATCH_BEGIN)
+            matchStart = strUtils::utf16Length(snippet);
+        else if (ch == SNIPPET_MATCH_END)
+            matches.push_back({matchStart, strUtils::utf16Length(snippet) - matchStart});
+        else
+            snippet += ch;
+    return SearchHit(nodeId, role, snippet, matches);
+}
+
+// Cuts a window of SNIPPET_LENGTH characters around the first matched term and marks every match
+static std::string markSnippet(const std::string &content, const std::vector<std::string> &terms)
+{
+    size_t first = std::string::npos;
+    for (const auto &term : terms)
+        first = std::min(first, content.find(term));
+    if (first == std::string::npos)
+        first = 0;
+
+    size_t begin = first, end = first;
+    for (size_t chars = 0; begin > 0 && chars < SNIPPET_LENGTH / 4; chars++)
+        do
+            begin--;
+        while (begin > 0 && (content[begin] & 0xC0) == 0x80);
+    for (size_t chars = 0; end < content.size() && chars < SNIPPET_LENGTH * 3 / 4; chars++)
+        do
+            end++;
+        while (end < content.size() && (content[end] & 0xC0) == 0x80);
+
+    std::string window = content.substr(begin, end - begin), marked;
+    for (size_t pos = 0; pos < window.size();)
+    {
+        bool matched = false;
+        for (const auto &term : terms)
+            if (!term.empty() && window.compare(pos, term.size(), term) == 0)
+            {
+                marked += SNIPPET_MATCH_BEGIN + term + SNIPPET_MATCH_END;
+                pos += term.size();
+                matched = true;
+                break;
+            }
+        if (!matched)
+            marked += window[pos++];
+    }
+    return (begin > 0 ? "…" : "") + marked + (end < content.size() ? "…" : "");
+}
+
+std::vector<SearchResult> ConversationManager::searchConversations(const std::string &query, size_t limit)
+{
+    std::vector<std::string> terms;
+    for (const auto &term : strUtils::split(query, " "))
+        if (!strUtils::trim(term).empty())
+            terms.push_back(strUtils::trim(term));
+    if (terms.empty())
+        return {};
+
+    // The trigram tokenizer cannot index terms shorter than three characters
+    bool useFts = ftsAvailable;
+    for (const auto &term : terms)
+        if (strUtils::utf8Length(term) < 3)
+            useFts = false;
+
+    // Hits in rank order; the scan path builds snippets itself
+    std::vector<SearchHitRow> rows;
+    if (useFts)
+    {
+        std::string match;
+        for (const auto &term : terms)
+        {
+            std::string quoted = "\"";
+            for (char ch : term)
+                quoted += (ch == '"') ? std::string("\"\"") : std::string(1, ch);
+            match += quoted + "\" ";
+        }
+        match.pop_back();
+        auto hits = database.read("SELECT n.id AS id, n.conversation_id AS conversation_id, n.role AS role, "
+                              "c.title AS title, c.updated_at AS updated_at, "
+                              "snippet(conversation_nodes_fts, 0, char(2), char(3), '…', " +
+                              std::to_string(SNIPPET_LENGTH) + ") AS snippet, "
+                              "-bm25(conversation_nodes_fts) AS rank "
+                              "FROM conversation_nodes_fts "
+                              "JOIN conversation_nodes n ON n.rowid = conversation_nodes_fts.rowid "
+                              "JOIN conversations c ON c.id = n.conversation_id "
+                              "WHERE conversation_nodes_fts MATCH ? AND n.role != 2 "
+                              "ORDER BY bm25(conversation_nodes_fts) LIMIT ?")
+                        .bind(match)
+                        .bind(limit)
+                        .execute();
+        for (const auto &hit : hits)
+            rows.push_back({std::string(hit.getText(0)), std::string(hit.getText(1)), (int)hit.getInt(2),
+                            std::string(hit.getText(3)), hit.getInt(4), std::string(hit.getText(5)), hit.getDouble(6)});
+    }
+    else
+    {
+        std::string sql = "SELECT n.id AS id, n.conversation_id AS conversation_id, n.role AS role, "
+                          "c.title AS title, c.updated_at AS updated_at, n.content AS content "
+                          "FROM conversation_nodes n "
+                          "JOIN conversations c ON c.id = n.conversation_id "
+                          "WHERE n.role != 2";
+        for (size_t i = 0; i < terms.size(); i++)
+            sql += " AND instr(n.content, ?) > 0";
+        sql += " ORDER BY c.updated_at DESC LIMIT ?";
+        QUERY search = database.read(sql);
+        for (const auto &term : terms)
+            (void)search.bind(term);
+        for (const auto &hit : search.bind(limit).execute())
+            rows.push_back({std::string(hit.getText(0)), std::string(hit.getText(1)), (int)hit.getInt(2),
+                            std::string(hit.getText(3)), hit.getInt(4), markSnippet(std::string(hit.getText(5)), terms), 0});
+    }
+
+    std::vector<SearchResult> results;
+    std::unordered_map<std::string, size_t> resultIndex;
+    for (const auto &row : rows)
+    {
+        auto it = resultIndex.find(row.conversationId);
+        if (it == resultIndex.end())
+        {
+            it = resultIndex.emplace(row.conversationId, results.size()).first;
+            results.push_back(SearchResult(row.conversationId, row.title, row.updatedAt, row.rank));
+        }
+        results[it->second].hits.push_back(makeHit(row.nodeId, row.role, row.snippet));
+    }
+    return results;
+}
+
+void ConversationManager::saveApiSettings(const std::string &apiKey, const std::string &baseUrl,
+                                          const std::string &model, int maxTokens,
+                                          double temperature, double topP, const std::string &systemPrompt,
+                                          int contextTokens)
+{
+    // Runs on the writer thread, which holds the connection and so must not wait for dbMutex
+    database.write([this, apiKey, baseUrl, model, maxTokens, temperature, topP, systemPrompt, contextTokens]()
+                   { database.upsert("api_settings")
+                         .value("id", "default")
+                         .value("api_key", apiKey)
+                         .value("base_url", baseUrl)
+                         .value("model", model)
+                         .value("max_tokens", maxTokens)
+                         .value("temperature", temperature)
+                         .value("top_p", topP)
+                         .value("system_prompt", systemPrompt)
+                         .value("context_tokens", contextTokens)
+                         .conflict("id")
+                         .update("api_key")
+                         .update("base_url")
+                         .update("model")
+                         .update("max_tokens")
+                         .update("temperature")
+                         .update("top_p")
+                         .update("system_prompt")
+                         .update("context_tokens")
+                         .execute(); },
+                   [](const std::string &error)
+                   { std::cerr << "Saving API settings failed: " << error << std::endl; });
+}
+
 void ConversationManager::loadApiSettings(std::string &apiKey, std::string &baseUrl,
                                           std::string &model, int &maxTokens,
-                                          double &temperature, double &topP, std::string &systemPrompt)
+                                          double &temperature, double &topP, std::string &systemPrompt,
+                                          int &contextTokens)
 {
-    std::lock_guard<std::mutex> lock(dbMutex);
     auto results = database.select("api_settings")
                        .where("id", "default")
                        .execute();
 
     if (!results.empty())
     {
-        const auto &row = results[0];
-        apiKey = row.at("api_key");
-        baseUrl = row.at("base_url");
-        model = row.at("model");
-        maxTokens = std::stoi(row.at("max_tokens"));
-        temperature = std::stod(row.at("temperature"));
-        topP = std::stod(row.at("top_p"));
-        systemPrompt = row.at("system_prompt");
+        auto row = results[0];
+        apiKey = row.getText("api_key");
+        baseUrl = row.getText("base_url");
+        model = row.getText("model");
+        maxTokens = row.getInt("max_tokens");
+        temperature = row.getDouble("temperature");
+        topP = row.getDouble("top_p");
+        systemPrompt = row.getText("system_prompt");
+        if (!row.isNull("context_tokens"))
+            contextTokens = row.getInt("context_tokens");
     }
 }
@@ -25,18 +25,32 @@
 #include "Database/Database.hpp"
 #include "ConversationNode.hpp"
 #include "ConversationInfo.hpp"
+#include "SearchResult.hpp"
+#include "AICallback.hpp"
 
 class ConversationManager
 {
 private:
     DATABASE database;
     mutable std::mutex dbMutex;
+    bool ftsAvailable = false;
+
+    void touchConversation(const std::string &conversationId, int64_t currentTime);
+    // Inserts node or updates it in place, keeping its rowid and created_at; the caller holds dbMutex
+    void upsertNode(const std::string &conversationId, const ConversationNode &node, int64_t currentTime);
 
 public:
-    ConversationManager();
+    ConversationManager(const std::string &filePath = "/userdisk/database/langningchen-ai.db",
+                        const DatabaseOptions &options = DatabaseOptions::conversationHistory());
     ~ConversationManager() = default;
 
     std::vector<ConversationInfo> getConversationList();
+    // Up to count conversations, most recently updated first, that sort after (beforeUpdatedAt, beforeId)
+    RESULT getConversationPage(size_t count, int64_t beforeUpdatedAt = INT64_MAX, const std::string &beforeId = "");
+    int subscribeConversations(ConversationChangeCallback callback);
+    void unsubscribeConversations(int subscriptionId);
+    // Statement timings, recorded from the first call on
+    PROFILER *getProfiler();
     void createConversation(const std::string &title, std::string &outConversationId);
     void deleteConversation(const std::string &conversationId);
     void updateConversationTitle(const std::string &conversationId, const std::string &title);
@@ -46,11 +60,16 @@ public:
     void loadConversation(const std::string &conversationId,
                           std::unordered_map<std::string, std::unique_ptr<ConversationNode>> &nodeMap,
                           std::string &rootNodeId, std::string &leafNodeId);
+    void saveNode(const std::string &conversationId, const ConversationNode &node);
+
+    std::vector<SearchResult> searchConversations(const std::string &query, size_t limit);
 
     void saveApiSettings(const std::string &apiKey, const std::string &baseUrl,
                          const std::string &model, int maxTokens,
-                         double temperature, double topP, const std::string &systemPrompt);
+                         double temperature, double topP, const std::string &systemPrompt,
+                         int contextTokens);
     void loadApiSettings(std::string &apiKey, std::string &baseUrl,
                          std::string &model, int &maxTokens,
-                         double &temperature, double &topP, std::string &systemPrompt);
+                         double &temperature, double &topP, std::string &systemPrompt,
+                         int &contextTokens);
 };
@@ -46,6 +46,11 @@ struct ConversationNode
     std::string parentId;
     std::vector<std::string> childIds;
     int64_t timestamp;
+    int tokenCount = -1; // -1 until estimated
+    bool streaming = false; // A reply still being generated, kept out of the search index
+    // Serialized {"role":...,"content":...} request message, empty until
+    // first sent and cleared whenever content changes
+    std::string requestFragment;
 
     ConversationNode(std::string id, ROLE role, std::string content, std::string parentId, STOP_REASON stopReason = STOP_REASON_NONE)
         : id(id), role(role), stopReason(stopReason), content(content), parentId(parentId),
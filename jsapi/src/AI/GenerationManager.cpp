@@ -0,0 +1,113 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "GenerationManager.hpp"
+#include "strUtils.hpp"
+#include <iostream>
+
+GenerationManager::GenerationManager(size_t maxWorkers) : maxWorkers(maxWorkers) {}
+GenerationManager::~GenerationManager()
+{
+    cancelAll();
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        stopping = true;
+        tasks.clear();
+    }
+    tasksCondition.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void GenerationManager::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex);
+            tasksCondition.wait(lock, [this]
+                                { return stopping || !tasks.empty(); });
+            if (stopping)
+                return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            idleWorkers--;
+        }
+        try
+        {
+            task();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Generation task error: " << e.what() << std::endl;
+        }
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        idleWorkers++;
+    }
+}
+
+Generation GenerationManager::begin(const std::string &conversationId, const std::string &parentNodeId)
+{
+    std::lock_guard<std::mutex> lock(generationsMutex);
+    Generation generation(strUtils::randomId(), conversationId, parentNodeId);
+    generations.emplace(generation.requestId, generation);
+    return generation;
+}
+void GenerationManager::end(const std::string &requestId)
+{
+    std::lock_guard<std::mutex> lock(generationsMutex);
+    generations.erase(requestId);
+}
+bool GenerationManager::cancel(const std::string &requestId)
+{
+    std::lock_guard<std::mutex> lock(generationsMutex);
+    auto it = generations.find(requestId);
+    if (it == generations.end())
+        return false;
+    it->second.cancelled->store(true);
+    return true;
+}
+void GenerationManager::cancelAll()
+{
+    std::lock_guard<std::mutex> lock(generationsMutex);
+    for (auto &pair : generations)
+        pair.second.cancelled->store(true);
+}
+std::vector<Generation> GenerationManager::getGenerations() const
+{
+    std::lock_guard<std::mutex> lock(generationsMutex);
+    std::vector<Generation> result;
+    for (const auto &pair : generations)
+        result.push_back(pair.second);
+    return result;
+}
+
+void GenerationManager::post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        tasks.push_back(std::move(task));
+        // Grow on demand so a fan-out runs all of its requests at once
+        if (idleWorkers < tasks.size() && workers.size() < maxWorkers)
+        {
+            workers.emplace_back(&GenerationManager::workerLoop, this);
+            idleWorkers++;
+        }
+    }
+    tasksCondition.notify_one();
+}
@@ -0,0 +1,70 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#include <unordered_map>
+
+struct Generation
+{
+    std::string requestId; // also the id of the assistant node being generated
+    std::string conversationId;
+    std::string parentNodeId;
+    std::shared_ptr<std::atomic<bool>> cancelled;
+
+    Generation(std::string requestId, std::string conversationId, std::string parentNodeId)
+        : requestId(requestId), conversationId(conversationId), parentNodeId(parentNodeId),
+          cancelled(std::make_shared<std::atomic<bool>>(false)) {}
+};
+
+class GenerationManager
+{
+private:
+    std::unordered_map<std::string, Generation> generations;
+    mutable std::mutex generationsMutex;
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex tasksMutex;
+    std::condition_variable tasksCondition;
+    size_t maxWorkers;
+    size_t idleWorkers = 0;
+    bool stopping = false;
+
+    void workerLoop();
+
+public:
+    GenerationManager(size_t maxWorkers = 8);
+    ~GenerationManager();
+
+    Generation begin(const std::string &conversationId, const std::string &parentNodeId);
+    void end(const std::string &requestId);
+    bool cancel(const std::string &requestId);
+    void cancelAll();
+    std::vector<Generation> getGenerations() const;
+
+    void post(std::function<void()> task);
+};
@@ -29,6 +29,18 @@ void JSAI::initialize(JQFunctionInfo &info)
         ASSERT(info.Length() == 0);
         std::lock_guard<std::mutex> lock(aiObjectMutex);
         AIObject = std::make_unique<AI>();
+        AIObject->subscribeConversations(
+            [this](const std::vector<ConversationInfo> &changed, bool removed)
+            {
+                Bson::array conversationsArray;
+                for (const auto &conv : changed)
+                    conversationsArray.push_back(Bson::object{
+                        {"id", conv.id},
+                        {"title", conv.title},
+                        {"createdAt", std::to_string(conv.createdAt)},
+                        {"updatedAt", std::to_string(conv.updatedAt)}});
+                publish("ai_conversations_changed", Bson::object{{"changed", conversationsArray}, {"removed", removed}});
+            });
         info.GetReturnValue().Set(true);
     }
     catch (const std::exception &e)
@@ -177,13 +189,68 @@ void JSAI::generateResponse(JQAsyncInfo &info)
         info.postError(e.what());
     }
 }
+void JSAI::startGeneration(JQFunctionInfo &info)
+{
+    try
+    {
+        ASSERT(AIObject != nullptr);
+        ASSERT(info.Length() <= 2);
+        JSContext *ctx = info.GetContext();
+        std::string conversationId = info.Length() >= 1 ? JQString(ctx, info[0]).getString() : AIObject->getConversationId();
+        std::string parentNodeId = info.Length() == 2 ? JQString(ctx, info[1]).getString() : AIObject->getCurrentNodeId();
+        ASSERT(!conversationId.empty());
+        ASSERT(!parentNodeId.empty());
+
+        info.GetReturnValue().Set(AIObject->startGeneration(conversationId, parentNodeId,
+                                                            getGenerationStreamCallback(), getGenerationDoneCallback()));
+    }
+    catch (const std::exception &e)
+    {
+        info.GetReturnValue().ThrowInternalError(e.what());
+    }
+}
+void JSAI::fanOut(JQFunctionInfo &info)
+{
+    try
+    {
+        ASSERT(AIObject != nullptr);
+        ASSERT(info.Length() == 1 || info.Length() == 2);
+        JSContext *ctx = info.GetContext();
+        Bson endpointsBson = JSValueToBson(ctx, info[0]);
+        ASSERT(endpointsBson.is_array());
+        bool race = info.Length() == 2 && JQBool(ctx, info[1]).getBool();
+
+        std::vector<Endpoint> endpoints;
+        for (const auto &endpointBson : endpointsBson.array_items())
+        {
+            ASSERT(endpointBson.is_object());
+            endpoints.emplace_back(endpointBson["apiKey"].string_value(),
+                                   endpointBson["baseUrl"].string_value(),
+                                   endpointBson["modelName"].string_value());
+        }
+
+        Bson::array requestIdsArray;
+        for (const auto &requestId : AIObject->fanOut(endpoints, race, getGenerationStreamCallback(), getGenerationDoneCallback()))
+            requestIdsArray.push_back(requestId);
+        info.GetReturnValue().Set(requestIdsArray);
+    }
+    catch (const std::exception &e)
+    {
+        info.GetReturnValue().ThrowInternalError(e.what());
+    }
+}
 void JSAI::stopGeneration(JQFunctionInfo &info)
 {
     try
     {
         AI *ai = getAIObject();
         ASSERT(ai != nullptr);
-        ASSERT(info.Length() == 0);
+        ASSERT(info.Length() <= 1);
+        if (info.Length() == 1)
+        {
+            info.GetReturnValue().Set(ai->stopGeneration(JQString(info.GetContext(), info[0]).getString()));
+            return;
+        }
         ai->stopGeneration();
         info.GetReturnValue().Set(true);
     }
@@ -192,6 +259,25 @@ void JSAI::stopGeneration(JQFunctionInfo &info)
         info.GetReturnValue().ThrowInternalError(e.what());
     }
 }
+void JSAI::getGenerations(JQFunctionInfo &info)
+{
+    try
+    {
+        ASSERT(AIObject != nullptr);
+        ASSERT(info.Length() == 0);
+        Bson::array generationsArray;
+        for (const auto &generation : AIObject->getGenerations())
+            generationsArray.push_back(Bson::object{
+                {"requestId", generation.requestId},
+                {"conversationId", generation.conversationId},
+                {"parentNodeId", generation.parentNodeId}});
+        info.GetReturnValue().Set(generationsArray);
+    }
+    catch (const std::exception &e)
+    {
+        info.GetReturnValue().ThrowInternalError(e.what());
+    }
+}
 void JSAI::getModels(JQAsyncInfo &info)
 {
     try
@@ -246,6 +332,57 @@ void JSAI::getConversationList(JQAsyncInfo &info)
     }
 }
 
+void JSAI::iterateConversations(JQFunctionInfo &info)
+{
+    try
+    {
+        ASSERT(AIObject != nullptr);
+        ASSERT(info.Length() == 0);
+        // Each page is read afresh from whichever AI is current, after the last conversation handed out
+        struct POSITION
+        {
+            int64_t updatedAt = INT64_MAX;
+            std::string id;
+        };
+        auto position = std::make_shared<POSITION>();
+        PAGER pages = [this, position]()
+        {
+            AI *ai = getAIObject();
+            ASSERT(ai != nullptr);
+            RESULT page = ai->getConversationPage(CONVERSATION_PAGE_SIZE, position->updatedAt, position->id);
+            if (!page.empty())
+            {
+                position->updatedAt = page[page.size() - 1].getInt("updatedAt");
+                position->id = std::string(page[page.size() - 1].getText("id"));
+            }
+            return page;
+        };
+        info.GetReturnValue().Set(JSCursor::create(tplEnv(), info.This(), pages));
+    }
+    catch (const std::exception &e)
+    {
+        info.GetReturnValue().ThrowInternalError(e.what());
+    }
+}
+
+void JSAI::getDatabaseStats(JQFunctionInfo &info)
+{
+    try
+    {
+        ASSERT(AIObject != nullptr);
+        ASSERT(info.Length() <= 1);
+        PROFILER *profiler = AIObject->getDatabaseProfiler();
+        ASSERT(profiler != nullptr);
+        info.GetReturnValue().Set(JSProfiler::toBson(*profiler));
+        if (info.Length() == 1 && JQBool(info.GetContext(), info[0]).getBool())
+            profiler->reset();
+    }
+    catch (const std::exception &e)
+    {
+        info.GetReturnValue().ThrowInternalError(e.what());
+    }
+}
+
 void JSAI::createConversation(JQAsyncInfo &info)
 {
     try
@@ -318,12 +455,57 @@ void JSAI::updateConversationTitle(JQAsyncInfo &info)
     }
 }
 
+void JSAI::searchConversations(JQAsyncInfo &info)
+{
+    try
+    {
+        ASSERT(AIObject != nullptr);
+        ASSERT(info.Length() >= 1 && info.Length() <= 2);
+        ASSERT(info[0].is_string());
+        size_t limit = 50;
+        if (info.Length() == 2)
+        {
+            ASSERT(info[1].is_number() && info[1].int_value() > 0);
+            limit = info[1].int_value();
+        }
+        Bson::array resultsArray;
+        for (const auto &result : AIObject->searchConversations(info[0].string_value(), limit))
+        {
+            Bson::array hitsArray;
+            for (const auto &hit : result.hits)
+            {
+                Bson::array matchesArray;
+                for (const auto &match : hit.matches)
+                    matchesArray.push_back(Bson::object{
+                        {"start", (int)match.first},
+                        {"length", (int)match.second}});
+                hitsArray.push_back(Bson::object{
+                    {"nodeId", hit.nodeId},
+                    {"role", hit.role},
+                    {"snippet", hit.snippet},
+                    {"matches", matchesArray}});
+            }
+            resultsArray.push_back(Bson::object{
+                {"id", result.conversationId},
+                {"title", result.title},
+                {"updatedAt", std::to_string(result.updatedAt)},
+                {"rank", result.rank},
+                {"hits", hitsArray}});
+        }
+        info.post(resultsArray);
+    }
+    catch (const std::exception &e)
+    {
+        info.postError(e.what());
+    }
+}
+
 void JSAI::setSettings(JQFunctionInfo &info)
 {
     try
     {
         ASSERT(AIObject != nullptr);
-        ASSERT(info.Length() == 7);
+        ASSERT(info.Length() == 7 || info.Length() == 8);
         JSContext *ctx = info.GetContext();
         std::string apiKey = JQString(ctx, info[0]).getString();
         std::string baseUrl = JQString(ctx, info[1]).getString();
@@ -332,8 +514,9 @@ void JSAI::setSettings(JQFunctionInfo &info)
         double temperature = JQNumber(ctx, info[4]).getDouble();
         double topP = JQNumber(ctx, info[5]).getDouble();
         std::string systemPrompt = JQString(ctx, info[6]).getString();
+        int contextTokens = info.Length() == 8 ? JQNumber(ctx, info[7]).getInt32() : AIObject->getSettings().contextTokens;
 
-        AIObject->setSettings(apiKey, baseUrl, modelName, maxTokens, temperature, topP, systemPrompt);
+        AIObject->setSettings(apiKey, baseUrl, modelName, maxTokens, temperature, topP, systemPrompt, contextTokens);
         info.GetReturnValue().Set(true);
     }
     catch (const std::exception &e)
@@ -355,7 +538,8 @@ void JSAI::getSettings(JQFunctionInfo &info)
             {"maxTokens", settings.maxTokens},
             {"temperature", settings.temperature},
             {"topP", settings.topP},
-            {"systemPrompt", settings.systemPrompt}});
+            {"systemPrompt", settings.systemPrompt},
+            {"contextTokens", settings.contextTokens}});
     }
     catch (const std::exception &e)
     {
@@ -379,19 +563,31 @@ extern JSValue createAI(JQModuleEnv *env)
 
     tpl->SetProtoMethodPromise("addUserMessage", &JSAI::addUserMessage);
     tpl->SetProtoMethodPromise("generateResponse", &JSAI::generateResponse);
+    tpl->SetProtoMethod("startGeneration", &JSAI::startGeneration);
+    tpl->SetProtoMethod("fanOut", &JSAI::fanOut);
     tpl->SetProtoMethod("stopGeneration", &JSAI::stopGeneration);
+    tpl->SetProtoMethod("getGenerations", &JSAI::getGenerations);
     tpl->SetProtoMethodPromise("getModels", &JSAI::getModels);
     tpl->SetProtoMethodPromise("getUserBalance", &JSAI::getUserBalance);
 
     tpl->SetProtoMethodPromise("getConversationList", &JSAI::getConversationList);
+    tpl->SetProtoMethod("iterateConversations", &JSAI::iterateConversations);
+    tpl->SetProtoMethod("getDatabaseStats", &JSAI::getDatabaseStats);
     tpl->SetProtoMethodPromise("createConversation", &JSAI::createConversation);
     tpl->SetProtoMethodPromise("loadConversation", &JSAI::loadConversation);
     tpl->SetProtoMethodPromise("deleteConversation", &JSAI::deleteConversation);
     tpl->SetProtoMethodPromise("updateConversationTitle", &JSAI::updateConversationTitle);
+    tpl->SetProtoMethodPromise("searchConversations", &JSAI::searchConversations);
 
     tpl->SetProtoMethod("setSettings", &JSAI::setSettings);
     tpl->SetProtoMethod("getSettings", &JSAI::getSettings);
 
+    // A streaming response can take minutes, keep it off the thread shared by the other async methods
+    tpl->setAsyncScheduleHook([](JQAsyncScheduleInfo &scheduleInfo)
+                              {
+                                  if (scheduleInfo.getPropName() == "generateResponse")
+                                      scheduleInfo.setThreadName(scheduleInfo.threadName() + "<generate>"); });
+
     JSAI::InitTpl(tpl);
     return tpl->CallConstructor();
 }
@@ -18,6 +18,8 @@
 #pragma once
 
 #include "AI.hpp"
+#include "Database/JSCursor.hpp"
+#include "Database/JSProfiler.hpp"
 #include <jqutil_v2/jqutil.h>
 #include <memory>
 #include <mutex>
@@ -36,7 +38,20 @@ private:
         return AIObject.get();
     }
 
+    AIGenerationStreamCallback getGenerationStreamCallback()
+    {
+        return [this](const std::string &requestId, const std::string &messageDelta)
+        { publish("ai_stream_" + requestId, messageDelta); };
+    }
+    AIGenerationDoneCallback getGenerationDoneCallback()
+    {
+        return [this](const std::string &requestId, const std::string &response, const std::string &error)
+        { publish("ai_done_" + requestId, Bson::object{{"content", response}, {"error", error}}); };
+    }
+
 public:
+    static constexpr size_t CONVERSATION_PAGE_SIZE = 50;
+
     JSAI();
     ~JSAI();
 
@@ -50,15 +65,21 @@ public:
 
     void addUserMessage(JQAsyncInfo &info);
     void generateResponse(JQAsyncInfo &info);
+    void startGeneration(JQFunctionInfo &info);
+    void fanOut(JQFunctionInfo &info);
     void stopGeneration(JQFunctionInfo &info);
+    void getGenerations(JQFunctionInfo &info);
     void getModels(JQAsyncInfo &info);
     void getUserBalance(JQAsyncInfo &info);
 
     void getConversationList(JQAsyncInfo &info);
+    void iterateConversations(JQFunctionInfo &info);
+    void getDatabaseStats(JQFunctionInfo &info);
     void createConversation(JQAsyncInfo &info);
     void loadConversation(JQAsyncInfo &info);
     void deleteConversation(JQAsyncInfo &info);
     void updateConversationTitle(JQAsyncInfo &info);
+    void searchConversations(JQAsyncInfo &info);
 
     void setSettings(JQFunctionInfo &info);
     void getSettings(JQFunctionInfo &info);
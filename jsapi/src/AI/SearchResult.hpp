@@ -0,0 +1,45 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct SearchHit
+{
+    std::string nodeId;
+    int role;
+    std::string snippet;
+    // [start, length) pairs in UTF-16 code units, relative to snippet
+    std::vector<std::pair<size_t, size_t>> matches;
+
+    SearchHit(std::string nodeId, int role, std::string snippet, std::vector<std::pair<size_t, size_t>> matches)
+        : nodeId(nodeId), role(role), snippet(snippet), matches(matches) {}
+};
+
+struct SearchResult
+{
+    std::string conversationId;
+    std::string title;
+    long long updatedAt;
+    double rank;
+    std::vector<SearchHit> hits;
+
+    SearchResult(std::string conversationId, std::string title, long long updatedAt, double rank)
+        : conversationId(conversationId), title(title), updatedAt(updatedAt), rank(rank) {}
+};
@@ -26,11 +26,13 @@ struct SettingsResponse
     double temperature;
     double topP;
     std::string systemPrompt;
+    int contextTokens;
 
     SettingsResponse(std::string apiKey, std::string baseUrl,
                      std::string modelName, int maxTokens,
-                     double temperature, double topP, std::string systemPrompt)
+                     double temperature, double topP, std::string systemPrompt,
+                     int contextTokens)
         : apiKey(apiKey), baseUrl(baseUrl), modelName(modelName),
           maxTokens(maxTokens), temperature(temperature), topP(topP),
-          systemPrompt(systemPrompt) {}
+          systemPrompt(systemPrompt), contextTokens(contextTokens) {}
 };
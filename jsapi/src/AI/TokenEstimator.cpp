@@ -0,0 +1,48 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "TokenEstimator.hpp"
+
+int TokenEstimator::estimate(const std::string &text)
+{
+    int tokens = 0;
+    size_t wordLength = 0;
+    for (size_t i = 0; i < text.size();)
+    {
+        unsigned char ch = text[i];
+        if (ch < 0x80)
+        {
+            if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9'))
+                wordLength++;
+            else
+            {
+                tokens += (wordLength + 3) / 4;
+                wordLength = 0;
+                if (ch != ' ' && ch != '\n' && ch != '\t' && ch != '\r')
+                    tokens++;
+            }
+            i++;
+            continue;
+        }
+        tokens += (wordLength + 3) / 4;
+        wordLength = 0;
+        tokens++;
+        i += (ch >= 0xF0) ? 4 : (ch >= 0xE0) ? 3 : (ch >= 0xC0) ? 2 : 1;
+    }
+    tokens += (wordLength + 3) / 4;
+    return tokens;
+}
@@ -0,0 +1,32 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+
+class TokenEstimator
+{
+public:
+    // Role markers and separators the chat template adds around every message
+    static constexpr int MESSAGE_OVERHEAD = 4;
+
+    // Approximates the BPE token count of a message body without a
+    // vocabulary: one token per CJK or other non-ASCII character, roughly
+    // four characters per ASCII word piece and one per punctuation mark.
+    static int estimate(const std::string &text);
+};
@@ -0,0 +1,69 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "BatchInsert.hpp"
+#include "Transaction.hpp"
+
+BATCH_INSERT::BATCH_INSERT(STATEMENT_CACHE *statements, std::string tableName)
+    : statements(statements), conn(statements ? statements->connection() : nullptr), tableName(tableName)
+{
+    ASSERT(conn != nullptr);
+    ASSERT(!tableName.empty());
+}
+BATCH_INSERT &BATCH_INSERT::column(std::string column)
+{
+    ASSERT(!column.empty());
+    ASSERT(values.empty());
+    this->columns.push_back(column);
+    return *this;
+}
+BATCH_INSERT &BATCH_INSERT::row(std::vector<VALUE> row)
+{
+    ASSERT(!columns.empty());
+    ASSERT(row.size() == columns.size());
+    for (auto &value : row)
+        this->values.push_back(std::move(value));
+    return *this;
+}
+size_t BATCH_INSERT::size() const { return columns.empty() ? 0 : values.size() / columns.size(); }
+size_t BATCH_INSERT::execute() const
+{
+    if (values.empty())
+        return 0;
+    std::string query = "INSERT INTO \"" + tableName + "\" (";
+    for (auto &column : columns)
+        query += "\"" + column + "\", ";
+    query.erase(query.end() - 2, query.end());
+    query += ") VALUES (";
+    for (size_t i = 0; i < columns.size(); i++)
+        query += "?, ";
+    query.erase(query.end() - 2, query.end());
+    query += ")";
+
+    TRANSACTION transaction(statements);
+    STATEMENT stmt = statements->acquire(query);
+    for (size_t i = 0; i < values.size(); i += columns.size())
+    {
+        for (size_t j = 0; j < columns.size(); j++)
+            ASSERT_DATABASE_OK(bindValue(stmt, j + 1, values[i + j], SQLITE_STATIC));
+        ASSERT_DATABASE_OK(sqlite3_step(stmt));
+        sqlite3_reset(stmt);
+    }
+    stmt.close();
+    transaction.commit();
+    return size();
+}
@@ -0,0 +1,52 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Statement.hpp"
+#include "Value.hpp"
+#include <vector>
+
+// Inserts many rows through one prepared statement inside one transaction
+class BATCH_INSERT
+{
+private:
+    STATEMENT_CACHE *statements;
+    sqlite3 *conn;
+    std::string tableName;
+    std::vector<std::string> columns;
+    std::vector<VALUE> values;
+
+    static VALUE toRowValue(VALUE data) { return data; }
+    template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+    static VALUE toRowValue(T data)
+    {
+        return toValue(data);
+    }
+
+public:
+    BATCH_INSERT(STATEMENT_CACHE *statements, std::string tableName);
+    [[nodiscard]] BATCH_INSERT &column(std::string column);
+    [[nodiscard]] BATCH_INSERT &row(std::vector<VALUE> row);
+    template <typename... Args>
+    [[nodiscard]] BATCH_INSERT &row(const Args &...args)
+    {
+        return row(std::vector<VALUE>{toRowValue(args)...});
+    }
+    size_t size() const;
+    size_t execute() const;
+};
@@ -0,0 +1,128 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "ChangeFeed.hpp"
+#include <algorithm>
+
+CHANGE_FEED::CHANGE_FEED(sqlite3 *conn) : conn(conn)
+{
+    ASSERT(conn != nullptr);
+    sqlite3_update_hook(conn, &CHANGE_FEED::onUpdate, this);
+    sqlite3_commit_hook(conn, &CHANGE_FEED::onCommit, this);
+    sqlite3_rollback_hook(conn, &CHANGE_FEED::onRollback, this);
+}
+CHANGE_FEED::~CHANGE_FEED()
+{
+    sqlite3_update_hook(conn, nullptr, nullptr);
+    sqlite3_commit_hook(conn, nullptr, nullptr);
+    sqlite3_rollback_hook(conn, nullptr, nullptr);
+}
+
+std::string CHANGE_FEED::key(int operation, const std::string &table, int64_t rowId)
+{
+    return std::to_string(operation) + ":" + std::to_string(rowId) + ":" + table;
+}
+void CHANGE_FEED::onUpdate(void *self, int operation, const char *, const char *table, sqlite3_int64 rowId)
+{
+    CHANGE_FEED *feed = static_cast<CHANGE_FEED *>(self);
+    std::lock_guard<std::mutex> lock(feed->feedMutex);
+    if (feed->subscriptions.empty())
+        return;
+    // Repeated writes to one row in a transaction are reported once
+    if (!feed->pendingKeys.insert(key(operation, table, rowId)).second)
+        return;
+    feed->pending.push_back({operation, table, rowId});
+}
+int CHANGE_FEED::onCommit(void *self)
+{
+    CHANGE_FEED *feed = static_cast<CHANGE_FEED *>(self);
+    std::lock_guard<std::mutex> lock(feed->feedMutex);
+    if (!feed->pending.empty())
+        feed->committed.push_back(std::move(feed->pending));
+    feed->pending.clear();
+    feed->pendingKeys.clear();
+    return 0;
+}
+void CHANGE_FEED::onRollback(void *self)
+{
+    CHANGE_FEED *feed = static_cast<CHANGE_FEED *>(self);
+    std::lock_guard<std::mutex> lock(feed->feedMutex);
+    feed->pending.clear();
+    feed->pendingKeys.clear();
+}
+
+size_t CHANGE_FEED::mark()
+{
+    std::lock_guard<std::mutex> lock(feedMutex);
+    return pending.size();
+}
+void CHANGE_FEED::rewind(size_t mark)
+{
+    std::lock_guard<std::mutex> lock(feedMutex);
+    while (pending.size() > mark)
+    {
+        pendingKeys.erase(key(pending.back().operation, pending.back().table, pending.back().rowId));
+        pending.pop_back();
+    }
+}
+
+int CHANGE_FEED::subscribe(std::vector<std::string> tables, CHANGE_CALLBACK callback)
+{
+    ASSERT(callback != nullptr);
+    std::lock_guard<std::mutex> lock(feedMutex);
+    subscriptions.push_back({nextId, std::unordered_set<std::string>(tables.begin(), tables.end()), callback});
+    return nextId++;
+}
+void CHANGE_FEED::unsubscribe(int id)
+{
+    std::lock_guard<std::mutex> lock(feedMutex);
+    subscriptions.erase(std::remove_if(subscriptions.begin(), subscriptions.end(),
+                                       [id](const SUBSCRIPTION &subscription)
+                                       { return subscription.id == id; }),
+                        subscriptions.end());
+}
+void CHANGE_FEED::dispatch()
+{
+    std::vector<std::vector<CHANGE>> transactions;
+    std::vector<SUBSCRIPTION> targets;
+    {
+        std::lock_guard<std::mutex> lock(feedMutex);
+        if (committed.empty())
+            return;
+        transactions.swap(committed);
+        targets = subscriptions;
+    }
+    // Callbacks run outside the lock so they may query or write the database themselves
+    for (const auto &transaction : transactions)
+        for (const auto &subscription : targets)
+        {
+            std::vector<CHANGE> changes;
+            for (const auto &change : transaction)
+                if (subscription.tables.empty() || subscription.tables.count(change.table))
+                    changes.push_back(change);
+            if (changes.empty())
+                continue;
+            try
+            {
+                subscription.callback(changes);
+            }
+            catch (const std::exception &)
+            {
+                // The write already committed; one failing subscriber must not fail it or starve the others
+            }
+        }
+}
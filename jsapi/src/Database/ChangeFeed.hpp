@@ -0,0 +1,76 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Includes.hpp"
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// A row written by a committed transaction, as reported by sqlite3_update_hook
+struct CHANGE
+{
+    int operation; // SQLITE_INSERT, SQLITE_UPDATE or SQLITE_DELETE
+    std::string table;
+    int64_t rowId;
+};
+using CHANGE_CALLBACK = std::function<void(const std::vector<CHANGE> &changes)>;
+
+// Collects the rows changed on one connection and hands them to table-filtered subscribers once per committed
+// transaction. Only writes made through this connection are seen; other processes have to be detected with
+// PRAGMA data_version instead. Savepoints rewind the pending rows when they are rolled back.
+class CHANGE_FEED
+{
+private:
+    struct SUBSCRIPTION
+    {
+        int id;
+        std::unordered_set<std::string> tables;
+        CHANGE_CALLBACK callback;
+    };
+
+    sqlite3 *conn;
+    std::mutex feedMutex;
+    std::vector<SUBSCRIPTION> subscriptions;
+    int nextId = 1;
+    std::vector<CHANGE> pending;
+    std::unordered_set<std::string> pendingKeys;
+    std::vector<std::vector<CHANGE>> committed;
+
+    static std::string key(int operation, const std::string &table, int64_t rowId);
+    static void onUpdate(void *self, int operation, const char *database, const char *table, sqlite3_int64 rowId);
+    static int onCommit(void *self);
+    static void onRollback(void *self);
+
+public:
+    CHANGE_FEED(sqlite3 *conn);
+    CHANGE_FEED(const CHANGE_FEED &) = delete;
+    CHANGE_FEED &operator=(const CHANGE_FEED &) = delete;
+    ~CHANGE_FEED();
+
+    // An empty table list receives every change
+    int subscribe(std::vector<std::string> tables, CHANGE_CALLBACK callback);
+    void unsubscribe(int id);
+    // Position of the open transaction's changes; a savepoint takes it when it opens and rewinds to it on rollback
+    size_t mark();
+    void rewind(size_t mark);
+    // Delivers committed transactions; called by the connection once no transaction is open
+    void dispatch();
+};
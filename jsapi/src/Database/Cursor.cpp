@@ -0,0 +1,67 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "Cursor.hpp"
+
+CURSOR::CURSOR(STATEMENT stmt, sqlite3 *conn) : stmt(std::move(stmt)), conn(conn), current(this->stmt) {}
+
+bool CURSOR::step(RESULT &rows)
+{
+    if (done)
+        return false;
+    started = true;
+    int res = sqlite3_step(stmt);
+    if (res == SQLITE_ROW)
+    {
+        rows.append(stmt);
+        return true;
+    }
+    done = true;
+    if (res != SQLITE_DONE)
+    {
+        // Read the message while the statement still holds the connection lock, another thread may overwrite it after
+        DatabaseError error(__FILE__, __LINE__, conn);
+        stmt.close();
+        throw error;
+    }
+    stmt.close();
+    return false;
+}
+bool CURSOR::next()
+{
+    current.clear();
+    return step(current);
+}
+RESULT::ROW CURSOR::row() const
+{
+    ASSERT(!current.empty());
+    return current[0];
+}
+RESULT CURSOR::fetchMany(size_t count)
+{
+    RESULT rows = current;
+    rows.clear();
+    while (count-- > 0 && step(rows))
+        ;
+    return rows;
+}
+
+CURSOR::iterator CURSOR::begin()
+{
+    ASSERT(!started);
+    return iterator(next() ? this : nullptr);
+}
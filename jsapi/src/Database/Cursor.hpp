@@ -0,0 +1,69 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Statement.hpp"
+#include "Result.hpp"
+#include <functional>
+
+// Returns the next batch of rows, each batch read by a statement of its own, and an empty RESULT once there
+// are no more. Unlike a CURSOR it holds nothing between batches, so it suits readers that may stop anywhere.
+using PAGER = std::function<RESULT()>;
+
+// Forward-only view over a running statement that steps it one row at a time.
+// Holds the statement, and with it the connection lock, until exhausted or destroyed.
+class CURSOR
+{
+private:
+    STATEMENT stmt;
+    sqlite3 *conn;
+    RESULT current;
+    bool started = false;
+    bool done = false;
+
+    bool step(RESULT &rows);
+
+public:
+    class iterator
+    {
+    private:
+        CURSOR *cursor;
+
+    public:
+        iterator(CURSOR *cursor) : cursor(cursor) {}
+        RESULT::ROW operator*() const { return cursor->row(); }
+        iterator &operator++()
+        {
+            if (!cursor->next())
+                cursor = nullptr;
+            return *this;
+        }
+        bool operator!=(const iterator &other) const { return cursor != other.cursor; }
+    };
+
+    CURSOR(STATEMENT stmt, sqlite3 *conn);
+    CURSOR(CURSOR &&) = default;
+
+    bool next();
+    RESULT::ROW row() const;
+    RESULT fetchMany(size_t count);
+    bool isDone() const { return done; }
+
+    iterator begin();
+    iterator end() { return iterator(nullptr); }
+};
@@ -17,20 +17,181 @@
 
 #include "Database.hpp"
 
-DATABASE::DATABASE(const std::string &filePath)
+DATABASE::DATABASE(const std::string &filePath, const DatabaseOptions &options)
 {
-    if (sqlite3_open(filePath.c_str(), &conn) != SQLITE_OK && conn)
+    int flags = options.readOnly ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+    if (sqlite3_open_v2(filePath.c_str(), &conn, flags, nullptr) != SQLITE_OK && conn)
+    {
         sqlite3_close(conn);
+        conn = nullptr;
+    }
+    if (!conn)
+        return;
+    statements = std::make_unique<STATEMENT_CACHE>(conn);
+    changes = std::make_unique<CHANGE_FEED>(conn);
+    statements->setChangeFeed(changes.get());
+    statements->onIdle([this]()
+                       { changes->dispatch(); });
+    slowStatementMillis = options.slowStatementMillis;
+    if (options.profile)
+        enableProfiler();
+
+    if (options.busyTimeout > 0)
+        sqlite3_busy_timeout(conn, options.busyTimeout);
+    if (!options.journalMode.empty())
+        pragma("journal_mode", options.journalMode);
+    if (!options.synchronous.empty())
+        pragma("synchronous", options.synchronous);
+    if (options.mmapSize > 0)
+        pragma("mmap_size", std::to_string(options.mmapSize));
+    if (options.cacheSize != 0)
+        pragma("cache_size", std::to_string(options.cacheSize));
+    if (options.tempStoreMemory)
+        pragma("temp_store", "MEMORY");
+    if (options.readConnections > 0)
+        openReaders(filePath, options);
+    if (options.asyncWrites)
+        writer = std::make_unique<WRITER>(statements.get(), options.writeQueueSize);
 }
 DATABASE::~DATABASE()
 {
+    writer.reset();
+    for (auto &reader : readers)
+    {
+        reader.statements.reset();
+        sqlite3_close(reader.conn);
+    }
+    statements.reset();
+    changes.reset();
     if (conn)
         sqlite3_close(conn);
 }
 
+bool DATABASE::isOpen() const { return conn != nullptr; }
+
 TABLE DATABASE::table(const std::string &tableName) { return TABLE(conn, tableName); }
-SELECT DATABASE::select(const std::string &tableName) { return SELECT(conn, tableName); }
-INSERT DATABASE::insert(const std::string &tableName) { return INSERT(conn, tableName); }
-DELETE DATABASE::remove(const std::string &tableName) { return DELETE(conn, tableName); }
-UPDATE DATABASE::update(const std::string &tableName) { return UPDATE(conn, tableName); }
-SIZE DATABASE::size(const std::string &tableName) { return SIZE(conn, tableName); }
+SELECT DATABASE::select(const std::string &tableName) { return SELECT(readStatements(), tableName); }
+INSERT DATABASE::insert(const std::string &tableName) { return INSERT(statements.get(), tableName); }
+UPSERT DATABASE::upsert(const std::string &tableName) { return UPSERT(statements.get(), tableName); }
+DELETE DATABASE::remove(const std::string &tableName) { return DELETE(statements.get(), tableName); }
+UPDATE DATABASE::update(const std::string &tableName) { return UPDATE(statements.get(), tableName); }
+SIZE DATABASE::size(const std::string &tableName) { return SIZE(readStatements(), tableName); }
+QUERY DATABASE::query(const std::string &sql) { return QUERY(statements.get(), sql); }
+QUERY DATABASE::read(const std::string &sql) { return QUERY(readStatements(), sql); }
+BATCH_INSERT DATABASE::batchInsert(const std::string &tableName) { return BATCH_INSERT(statements.get(), tableName); }
+TRANSACTION DATABASE::transaction() { return TRANSACTION(statements.get()); }
+std::future<void> DATABASE::write(std::function<void()> work, WRITE_ERROR_CALLBACK failed)
+{
+    if (writer)
+        return writer->post(work, failed);
+    std::promise<void> done;
+    try
+    {
+        auto transaction = this->transaction();
+        work();
+        transaction.commit();
+        done.set_value();
+    }
+    catch (const std::exception &e)
+    {
+        if (failed)
+            failed(e.what());
+        done.set_exception(std::current_exception());
+    }
+    catch (...)
+    {
+        done.set_exception(std::current_exception());
+    }
+    return done.get_future();
+}
+
+void DATABASE::openReaders(const std::string &filePath, const DatabaseOptions &options)
+{
+    // Outside WAL a reader's shared lock would hold up every commit of the writer
+    if (query("PRAGMA journal_mode").execute()[0].getString(0) != "wal")
+        return;
+    for (size_t i = 0; i < options.readConnections; i++)
+    {
+        sqlite3 *reader = nullptr;
+        if (sqlite3_open_v2(filePath.c_str(), &reader, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+        {
+            sqlite3_close(reader);
+            continue;
+        }
+        if (options.busyTimeout > 0)
+            sqlite3_busy_timeout(reader, options.busyTimeout);
+        std::string pragmas;
+        if (options.mmapSize > 0)
+            pragmas += "PRAGMA mmap_size = " + std::to_string(options.mmapSize) + ";";
+        if (options.cacheSize != 0)
+            pragmas += "PRAGMA cache_size = " + std::to_string(options.cacheSize) + ";";
+        if (options.tempStoreMemory)
+            pragmas += "PRAGMA temp_store = MEMORY;";
+        sqlite3_exec(reader, pragmas.c_str(), nullptr, nullptr, nullptr);
+        readers.push_back({reader, std::make_unique<STATEMENT_CACHE>(reader)});
+        if (profiler)
+        {
+            profiler->attach(reader);
+            readers.back().statements->setProfiler(profiler.get());
+        }
+    }
+}
+STATEMENT_CACHE *DATABASE::readStatements()
+{
+    if (readers.empty() || statements->inTransaction())
+        return statements.get();
+    return readers[std::hash<std::thread::id>()(std::this_thread::get_id()) % readers.size()].statements.get();
+}
+
+void DATABASE::pragma(const std::string &name, const std::string &value)
+{
+    // PRAGMA arguments cannot be bound; journal_mode returns a row, so step it like a query
+    (void)query("PRAGMA " + name + " = " + value).execute();
+}
+
+void DATABASE::migrate(int version, std::function<void()> migration)
+{
+    if (getVersion() >= version)
+        return;
+    auto transaction = this->transaction();
+    migration();
+    // PRAGMA arguments cannot be bound
+    ASSERT_DATABASE_OK(sqlite3_exec(conn, ("PRAGMA user_version = " + std::to_string(version)).c_str(), nullptr, nullptr, nullptr));
+    transaction.commit();
+}
+int DATABASE::getVersion() { return query("PRAGMA user_version").execute()[0].getInt(0); }
+
+int DATABASE::subscribe(std::vector<std::string> tables, CHANGE_CALLBACK callback)
+{
+    ASSERT(changes != nullptr);
+    return changes->subscribe(tables, callback);
+}
+void DATABASE::unsubscribe(int id)
+{
+    ASSERT(changes != nullptr);
+    changes->unsubscribe(id);
+}
+int64_t DATABASE::getDataVersion() { return query("PRAGMA data_version").execute()[0].getInt(0); }
+
+const STATEMENT_CACHE &DATABASE::getStatementCache() const { return *statements; }
+PROFILER *DATABASE::getProfiler() const
+{
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    return profiler.get();
+}
+PROFILER *DATABASE::enableProfiler()
+{
+    std::lock_guard<std::mutex> lock(profilerMutex);
+    if (!profiler && conn)
+    {
+        profiler = std::make_unique<PROFILER>(slowStatementMillis);
+        profiler->attach(conn);
+        statements->setProfiler(profiler.get());
+        for (auto &reader : readers)
+        {
+            profiler->attach(reader.conn);
+            reader.statements->setProfiler(profiler.get());
+        }
+    }
+    return profiler.get();
+}
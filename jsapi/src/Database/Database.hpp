@@ -26,23 +26,76 @@
 #include "Table.hpp"
 #include "Select.hpp"
 #include "Insert.hpp"
+#include "Upsert.hpp"
 #include "Delete.hpp"
 #include "Update.hpp"
 #include "Size.hpp"
+#include "Query.hpp"
+#include "Statement.hpp"
+#include "DatabaseOptions.hpp"
+#include "Transaction.hpp"
+#include "BatchInsert.hpp"
+#include "ChangeFeed.hpp"
+#include "Writer.hpp"
+#include <memory>
 
 class DATABASE
 {
 private:
     sqlite3 *conn;
+    std::unique_ptr<STATEMENT_CACHE> statements;
+    std::unique_ptr<CHANGE_FEED> changes;
+    std::unique_ptr<WRITER> writer;
+    std::unique_ptr<PROFILER> profiler;
+    mutable std::mutex profilerMutex;
+    int slowStatementMillis = 100;
+    struct READER
+    {
+        sqlite3 *conn;
+        std::unique_ptr<STATEMENT_CACHE> statements;
+    };
+    std::vector<READER> readers;
+
+    void pragma(const std::string &name, const std::string &value);
+    void openReaders(const std::string &filePath, const DatabaseOptions &options);
+    // A read connection picked by thread, or the writer when there is none or the thread is inside a transaction
+    STATEMENT_CACHE *readStatements();
 
 public:
-    DATABASE(const std::string &filePath);
+    DATABASE(const std::string &filePath, const DatabaseOptions &options = DatabaseOptions());
     ~DATABASE();
+    bool isOpen() const;
 
     TABLE table(const std::string &tableName);
     SELECT select(const std::string &tableName);
     INSERT insert(const std::string &tableName);
+    UPSERT upsert(const std::string &tableName);
     DELETE remove(const std::string &tableName);
     UPDATE update(const std::string &tableName);
     SIZE size(const std::string &tableName);
+    QUERY query(const std::string &sql);
+    // For SQL that only reads; may run on a read connection and so not see this thread's open transaction
+    QUERY read(const std::string &sql);
+    BATCH_INSERT batchInsert(const std::string &tableName);
+    [[nodiscard]] TRANSACTION transaction();
+    // Runs work in a transaction: on the writer thread with DatabaseOptions::asyncWrites, otherwise right here.
+    // work must not wait for another write, the writer would be waiting on itself. See WRITER::post for failed.
+    std::future<void> write(std::function<void()> work, WRITE_ERROR_CALLBACK failed = nullptr);
+
+    // Runs migration in a transaction and records version in PRAGMA user_version,
+    // unless the database is already at that version. Call in ascending order.
+    void migrate(int version, std::function<void()> migration);
+    int getVersion();
+
+    // Called after each committed transaction with the rows it changed in tables (every table when empty)
+    int subscribe(std::vector<std::string> tables, CHANGE_CALLBACK callback);
+    void unsubscribe(int id);
+    // Changes whenever another connection commits, so pollers of a shared file can skip unchanged rounds
+    int64_t getDataVersion();
+
+    const STATEMENT_CACHE &getStatementCache() const;
+    // nullptr until opened with DatabaseOptions::profile or enableProfiler() was called
+    PROFILER *getProfiler() const;
+    // Starts recording statement timings from now on, for diagnostics; later calls return the same profiler
+    PROFILER *enableProfiler();
 };
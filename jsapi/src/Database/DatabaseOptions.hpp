@@ -0,0 +1,89 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Connection settings applied right after the database is opened.
+// Empty strings and zero sizes leave SQLite's default in place.
+class DatabaseOptions
+{
+public:
+    bool readOnly = false;
+    std::string journalMode;
+    std::string synchronous;
+    int64_t mmapSize = 0;
+    int cacheSize = 0; // negative values are KiB, as in PRAGMA cache_size
+    bool tempStoreMemory = false;
+    int busyTimeout = 0; // milliseconds
+    // DATABASE::write() queues to a writer thread instead of running on the caller
+    bool asyncWrites = false;
+    size_t writeQueueSize = 64;
+    // Read-only connections for select(), size() and read(); only opened when the journal mode ends up as WAL,
+    // where they never block the writer
+    size_t readConnections = 0;
+    // Record per-statement timings (DATABASE::getProfiler()); runs slower than slowStatementMillis are also logged.
+    // On from the start only in debug builds, elsewhere DATABASE::enableProfiler() turns it on when asked for
+#ifdef NDEBUG
+    bool profile = false;
+#else
+    bool profile = true;
+#endif
+    int slowStatementMillis = 100;
+
+    // Streamed assistant replies write often, losing the last commit on power loss is acceptable
+    static DatabaseOptions conversationHistory()
+    {
+        DatabaseOptions options;
+        options.journalMode = "WAL";
+        options.synchronous = "NORMAL";
+        options.mmapSize = 8 * 1024 * 1024;
+        options.cacheSize = -2048;
+        options.tempStoreMemory = true;
+        options.busyTimeout = 2000;
+        options.asyncWrites = true;
+        options.readConnections = 2;
+        return options;
+    }
+    // Small frequent frequency bumps, read mostly at startup
+    static DatabaseOptions userDictionary()
+    {
+        DatabaseOptions options;
+        options.journalMode = "WAL";
+        options.synchronous = "NORMAL";
+        options.mmapSize = 4 * 1024 * 1024;
+        options.cacheSize = -1024;
+        options.tempStoreMemory = true;
+        options.busyTimeout = 1000;
+        options.asyncWrites = true;
+        return options;
+    }
+    // A database owned by another process: never write, wait for its writer instead of failing
+    static DatabaseOptions externalReadOnly()
+    {
+        DatabaseOptions options;
+        options.readOnly = true;
+        options.mmapSize = 1024 * 1024;
+        options.cacheSize = -256;
+        options.tempStoreMemory = true;
+        options.busyTimeout = 1000;
+        return options;
+    }
+};
@@ -17,33 +17,30 @@
 
 #include "Delete.hpp"
 
-DELETE::DELETE(sqlite3 *conn, std::string tableName) : conn(conn), tableName(tableName)
+DELETE::DELETE(STATEMENT_CACHE *statements, std::string tableName)
+    : statements(statements), conn(statements ? statements->connection() : nullptr), tableName(tableName)
 {
     ASSERT(conn != nullptr);
     ASSERT(!tableName.empty());
 }
-DELETE &DELETE::where(std::string column, std::string value)
+DELETE &DELETE::where(std::string column, VALUE value)
 {
     ASSERT(!column.empty());
-    ASSERT(!value.empty());
-    this->conditions.push_back({column, value});
+    ASSERT(!isEmptyValue(value));
+    this->conditions = this->conditions && WHERE::eq(column, value);
+    return *this;
+}
+DELETE &DELETE::where(const WHERE &predicate)
+{
+    this->conditions = this->conditions && predicate;
     return *this;
 }
 void DELETE::execute() const
 {
     std::string query = "DELETE FROM \"" + tableName + "\"";
     if (!conditions.empty())
-    {
-        query += " WHERE ";
-        for (auto &condition : conditions)
-            query += "\"" + condition.first + "\"=? AND ";
-        query.erase(query.end() - 5, query.end());
-    }
-    sqlite3_stmt *stmt = nullptr;
-    ASSERT_DATABASE_OK(sqlite3_prepare_v2(conn, query.c_str(), -1, &stmt, nullptr));
-    int idx = 1;
-    for (auto &condition : conditions)
-        ASSERT_DATABASE_OK(sqlite3_bind_text(stmt, idx++, condition.second.c_str(), -1, SQLITE_TRANSIENT));
+        query += " WHERE " + conditions.toString();
+    STATEMENT stmt = statements->acquire(query);
+    conditions.bind(stmt, 1, SQLITE_STATIC);
     ASSERT_DATABASE_OK(sqlite3_step(stmt));
-    ASSERT_DATABASE_OK(sqlite3_finalize(stmt));
 }
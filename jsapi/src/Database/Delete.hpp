@@ -17,23 +17,27 @@
 
 #pragma once
 
-#include "Includes.hpp"
+#include "Statement.hpp"
+#include "Value.hpp"
+#include "Where.hpp"
 #include <vector>
 
 class DELETE
 {
 private:
+    STATEMENT_CACHE *statements;
     sqlite3 *conn;
     std::string tableName;
-    std::vector<std::pair<std::string, std::string>> conditions;
+    WHERE conditions;
 
 public:
-    DELETE(sqlite3 *conn, std::string tableName);
-    [[nodiscard]] DELETE &where(std::string column, std::string value);
+    DELETE(STATEMENT_CACHE *statements, std::string tableName);
+    [[nodiscard]] DELETE &where(std::string column, VALUE value);
     template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
     [[nodiscard]] DELETE &where(std::string column, T data)
     {
-        return where(column, std::to_string(data));
+        return where(column, toValue(data));
     }
+    [[nodiscard]] DELETE &where(const WHERE &predicate);
     void execute() const;
 };
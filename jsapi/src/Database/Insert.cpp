@@ -17,12 +17,13 @@
 
 #include "Insert.hpp"
 
-INSERT::INSERT(sqlite3 *conn, std::string tableName) : conn(conn), tableName(tableName)
+INSERT::INSERT(STATEMENT_CACHE *statements, std::string tableName)
+    : statements(statements), conn(statements ? statements->connection() : nullptr), tableName(tableName)
 {
     ASSERT(conn != nullptr);
     ASSERT(!tableName.empty());
 }
-INSERT &INSERT::value(std::string column, std::string data)
+INSERT &INSERT::value(std::string column, VALUE data)
 {
     ASSERT(!column.empty());
     this->columns.push_back(column);
@@ -40,13 +41,11 @@ int64_t INSERT::execute() const
         query += "?, ";
     query.erase(query.end() - 2, query.end());
     query += ")";
-    sqlite3_stmt *stmt = nullptr;
-    ASSERT_DATABASE_OK(sqlite3_prepare_v2(conn, query.c_str(), -1, &stmt, nullptr));
+    STATEMENT stmt = statements->acquire(query);
     int idx = 1;
     for (auto &value : values)
-        ASSERT_DATABASE_OK(sqlite3_bind_text(stmt, idx++, value.c_str(), -1, SQLITE_TRANSIENT));
+        ASSERT_DATABASE_OK(bindValue(stmt, idx++, value, SQLITE_STATIC));
     ASSERT_DATABASE_OK(sqlite3_step(stmt));
     int64_t lastId = sqlite3_last_insert_rowid(conn);
-    ASSERT_DATABASE_OK(sqlite3_finalize(stmt));
     return lastId;
 }
@@ -17,24 +17,26 @@
 
 #pragma once
 
-#include "Includes.hpp"
+#include "Statement.hpp"
+#include "Value.hpp"
 #include <vector>
 
 class INSERT
 {
 private:
+    STATEMENT_CACHE *statements;
     sqlite3 *conn;
     std::string tableName;
     std::vector<std::string> columns;
-    std::vector<std::string> values;
+    std::vector<VALUE> values;
 
 public:
-    INSERT(sqlite3 *conn, std::string tableName);
-    [[nodiscard]] INSERT &value(std::string column, std::string data);
+    INSERT(STATEMENT_CACHE *statements, std::string tableName);
+    [[nodiscard]] INSERT &value(std::string column, VALUE data);
     template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
     [[nodiscard]] INSERT &value(std::string column, T data)
     {
-        return value(column, std::to_string(data));
+        return value(column, toValue(data));
     }
     int64_t execute() const;
 };
@@ -0,0 +1,88 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "JSCursor.hpp"
+#include <limits>
+
+JSCursor::JSCursor(PAGER pages) : pages(std::move(pages)) {}
+
+JSValue JSCursor::onIteratorNext(JQIterObject &iter)
+{
+    try
+    {
+        if (index == page.size())
+        {
+            if (done)
+                return JS_UNDEFINED;
+            page = pages();
+            index = 0;
+            if (page.empty())
+            {
+                done = true;
+                return JS_UNDEFINED;
+            }
+        }
+        iter.done = false;
+        return bsonToJSValue(iter.getContext(), toBson(page[index++]));
+    }
+    catch (const std::exception &e)
+    {
+        return JS_ThrowInternalError(iter.getContext(), "%s", e.what());
+    }
+}
+
+Bson JSCursor::toBson(const RESULT::ROW &row)
+{
+    Bson::object object;
+    for (size_t i = 0; i < row.columnCount(); i++)
+        switch (row.getType(i))
+        {
+        case SQLITE_INTEGER:
+        {
+            int64_t value = row.getInt(i);
+            if (value >= std::numeric_limits<int>::min() && value <= std::numeric_limits<int>::max())
+                object[row.columnName(i)] = (int)value;
+            else
+                object[row.columnName(i)] = (double)value;
+            break;
+        }
+        case SQLITE_FLOAT:
+            object[row.columnName(i)] = row.getDouble(i);
+            break;
+        case SQLITE_TEXT:
+            object[row.columnName(i)] = std::string(row.getText(i));
+            break;
+        case SQLITE_BLOB:
+        {
+            std::string_view blob = row.getBlob(i);
+            object[row.columnName(i)] = Bson::binary(blob.begin(), blob.end());
+            break;
+        }
+        default:
+            object[row.columnName(i)] = Bson();
+        }
+    return object;
+}
+
+JSValue JSCursor::create(JQTemplateEnvRef env, JSValueConst owner, PAGER pages)
+{
+    // The cursor hangs off an iterable of its own, so it is freed with it instead of piling up on owner
+    JSValue iterable = JQIterObject::CreateTpl(env)->NewInstance();
+    JS_SetPropertyStr(env->context(), iterable, "owner", JS_DupValue(env->context(), owner));
+    JQIterObject::SetIterator(env->context(), iterable, KeepPtr<JQIterNextInterf>(new JSCursor(std::move(pages))));
+    return iterable;
+}
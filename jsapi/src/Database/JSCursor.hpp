@@ -0,0 +1,42 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Cursor.hpp"
+#include <jqutil_v2/jqutil.h>
+
+using namespace JQUTIL_NS;
+
+// Exposes rows to JS as an iterable yielding one plain object per row. They are pulled from a PAGER a batch
+// at a time, so an abandoned or half-read iterator keeps no statement, connection lock or snapshot open.
+class JSCursor : public JQIterNextInterf
+{
+private:
+    PAGER pages;
+    RESULT page;
+    size_t index = 0;
+    bool done = false;
+
+public:
+    JSCursor(PAGER pages);
+    JSValue onIteratorNext(JQIterObject &iter) override;
+
+    static Bson toBson(const RESULT::ROW &row);
+    // owner is kept alive as long as the iterable, for pages that read through it
+    static JSValue create(JQTemplateEnvRef env, JSValueConst owner, PAGER pages);
+};
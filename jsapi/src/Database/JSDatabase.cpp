@@ -0,0 +1,267 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "JSDatabase.hpp"
+#include <cmath>
+#include <cstring>
+
+JSDatabase::JSDatabase() {}
+JSDatabase::~JSDatabase() {}
+
+std::shared_ptr<DATABASE> JSDatabase::getDatabase(const Bson &handle)
+{
+    ASSERT(handle.is_number());
+    std::lock_guard<std::mutex> lock(databasesMutex);
+    auto it = databases.find(handle.int_value());
+    ASSERT(it != databases.end());
+    return it->second;
+}
+VALUE JSDatabase::toValue(const Bson &value)
+{
+    switch (value.type())
+    {
+    case Bson::NUL:
+        return nullptr;
+    case Bson::BOOL:
+        return (int64_t)value.bool_value();
+    case Bson::INT:
+        return (int64_t)value.int_value();
+    case Bson::DOUBLE:
+    {
+        // JS has no integer type; keep whole numbers INTEGER so they compare equal to stored integers
+        double number = value.double_value();
+        if (std::trunc(number) == number && std::fabs(number) < 9007199254740992.0)
+            return (int64_t)number;
+        return number;
+    }
+    case Bson::STRING:
+        return value.string_value();
+    case Bson::BINARY:
+        return value.binary_value();
+    default:
+        THROW_EXCEPTION("parameters must be numbers, strings, booleans, null or ArrayBuffers");
+    }
+}
+QUERY &JSDatabase::bindAll(QUERY &query, const Bson &params)
+{
+    ASSERT(params.is_null() || params.is_array());
+    for (const auto &param : params.array_items())
+        (void)query.bind(toValue(param));
+    return query;
+}
+Bson JSDatabase::pack(const RESULT &result)
+{
+    Bson::array columns;
+    Bson::array values;
+    for (size_t column = 0; column < result.columnCount(); column++)
+    {
+        columns.push_back(result.columnName(column));
+        bool numeric = true;
+        for (const auto &row : result)
+            if (row.getType(column) == SQLITE_TEXT || row.getType(column) == SQLITE_BLOB)
+            {
+                numeric = false;
+                break;
+            }
+        if (numeric)
+        {
+            std::vector<uint8_t> packed(result.size() * sizeof(double));
+            size_t offset = 0;
+            for (const auto &row : result)
+            {
+                double number = row.isNull(column) ? NAN : row.getDouble(column);
+                memcpy(packed.data() + offset, &number, sizeof(double));
+                offset += sizeof(double);
+            }
+            values.push_back(packed);
+            continue;
+        }
+        Bson::array cells;
+        cells.reserve(result.size());
+        for (const auto &row : result)
+            switch (row.getType(column))
+            {
+            case SQLITE_NULL:
+                cells.push_back(Bson());
+                break;
+            case SQLITE_INTEGER:
+            case SQLITE_FLOAT:
+                cells.push_back(row.getDouble(column));
+                break;
+            case SQLITE_BLOB:
+            {
+                std::string_view blob = row.getBlob(column);
+                cells.push_back(std::vector<uint8_t>(blob.begin(), blob.end()));
+                break;
+            }
+            default:
+                cells.push_back(std::string(row.getText(column)));
+            }
+        values.push_back(cells);
+    }
+    return Bson::object{{"columns", columns}, {"rowCount", (double)result.size()}, {"values", values}};
+}
+
+void JSDatabase::open(JQAsyncInfo &info)
+{
+    try
+    {
+        ASSERT(info.Length() == 1 || info.Length() == 2);
+        ASSERT(info[0].is_string());
+        const Bson &settings = info.Length() == 2 ? info[1] : Bson();
+        ASSERT(settings.is_null() || settings.is_object());
+
+        DatabaseOptions options;
+        options.readOnly = settings["readOnly"].bool_value();
+        if (!options.readOnly)
+        {
+            options.journalMode = "WAL";
+            options.synchronous = "NORMAL";
+        }
+        options.tempStoreMemory = true;
+        options.busyTimeout = 2000;
+        options.readConnections = settings["readConnections"].is_number() ? settings["readConnections"].int_value() : 0;
+        options.profile = settings["profile"].bool_value();
+
+        auto database = std::make_shared<DATABASE>(info[0].string_value(), options);
+        ASSERT(database->isOpen());
+        std::lock_guard<std::mutex> lock(databasesMutex);
+        int handle = nextHandle++;
+        databases[handle] = database;
+        info.post(handle);
+    }
+    catch (const std::exception &e)
+    {
+        info.postError(e.what());
+    }
+}
+void JSDatabase::close(JQAsyncInfo &info)
+{
+    try
+    {
+        ASSERT(info.Length() == 1);
+        ASSERT(info[0].is_number());
+        std::shared_ptr<DATABASE> database;
+        {
+            std::lock_guard<std::mutex> lock(databasesMutex);
+            auto it = databases.find(info[0].int_value());
+            ASSERT(it != databases.end());
+            database = std::move(it->second);
+            databases.erase(it);
+        }
+        // Calls still running on it keep their reference; the file is closed once the last one returns
+        database.reset();
+        info.post({});
+    }
+    catch (const std::exception &e)
+    {
+        info.postError(e.what());
+    }
+}
+
+void JSDatabase::query(JQAsyncInfo &info)
+{
+    try
+    {
+        ASSERT(info.Length() == 2 || info.Length() == 3);
+        ASSERT(info[1].is_string());
+        auto database = getDatabase(info[0]);
+        QUERY query = database->read(info[1].string_value());
+        info.post(pack(bindAll(query, info.Length() == 3 ? info[2] : Bson()).execute()));
+    }
+    catch (const std::exception &e)
+    {
+        info.postError(e.what());
+    }
+}
+void JSDatabase::exec(JQAsyncInfo &info)
+{
+    try
+    {
+        ASSERT(info.Length() == 2 || info.Length() == 3);
+        ASSERT(info[1].is_string());
+        auto database = getDatabase(info[0]);
+        QUERY query = database->query(info[1].string_value());
+        (void)bindAll(query, info.Length() == 3 ? info[2] : Bson()).execute();
+        info.post({});
+    }
+    catch (const std::exception &e)
+    {
+        info.postError(e.what());
+    }
+}
+void JSDatabase::queryBatch(JQAsyncInfo &info)
+{
+    try
+    {
+        ASSERT(info.Length() == 3);
+        ASSERT(info[1].is_string());
+        ASSERT(info[2].is_array());
+        auto database = getDatabase(info[0]);
+        Bson::array results;
+        for (const auto &params : info[2].array_items())
+        {
+            QUERY query = database->read(info[1].string_value());
+            results.push_back(pack(bindAll(query, params).execute()));
+        }
+        info.post(results);
+    }
+    catch (const std::exception &e)
+    {
+        info.postError(e.what());
+    }
+}
+void JSDatabase::execBatch(JQAsyncInfo &info)
+{
+    try
+    {
+        ASSERT(info.Length() == 3);
+        ASSERT(info[1].is_string());
+        ASSERT(info[2].is_array());
+        auto database = getDatabase(info[0]);
+        // One transaction and one cached statement for the whole batch; any failure rolls every set back
+        auto transaction = database->transaction();
+        for (const auto &params : info[2].array_items())
+        {
+            QUERY query = database->query(info[1].string_value());
+            (void)bindAll(query, params).execute();
+        }
+        transaction.commit();
+        info.post((int)info[2].array_items().size());
+    }
+    catch (const std::exception &e)
+    {
+        info.postError(e.what());
+    }
+}
+
+JSValue createDatabase(JQModuleEnv *env)
+{
+    JQFunctionTemplateRef tpl = JQFunctionTemplate::New(env, "Database");
+    tpl->InstanceTemplate()->setObjectCreator([]()
+                                              { return new JSDatabase(); });
+
+    tpl->SetProtoMethodPromise("open", &JSDatabase::open);
+    tpl->SetProtoMethodPromise("close", &JSDatabase::close);
+    tpl->SetProtoMethodPromise("query", &JSDatabase::query);
+    tpl->SetProtoMethodPromise("exec", &JSDatabase::exec);
+    tpl->SetProtoMethodPromise("queryBatch", &JSDatabase::queryBatch);
+    tpl->SetProtoMethodPromise("execBatch", &JSDatabase::execBatch);
+
+    JSDatabase::InitTpl(tpl);
+    return tpl->CallConstructor();
+}
@@ -0,0 +1,57 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Database.hpp"
+#include <jqutil_v2/jqutil.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+using namespace JQUTIL_NS;
+
+// The DATABASE layer as a JS module for pages that need local storage. Databases are addressed by the handle
+// open() returns; every call runs on the module's async thread, never on the JS thread.
+//
+// Results are packed by column: a column holding only numbers and NULLs arrives as an ArrayBuffer of float64
+// (NULL is NaN, integers beyond 2^53 lose precision), any other column as a plain array of values.
+class JSDatabase : public JQPublishObject
+{
+private:
+    std::unordered_map<int, std::shared_ptr<DATABASE>> databases;
+    std::mutex databasesMutex;
+    int nextHandle = 1;
+
+    std::shared_ptr<DATABASE> getDatabase(const Bson &handle);
+    static VALUE toValue(const Bson &value);
+    static QUERY &bindAll(QUERY &query, const Bson &params);
+    static Bson pack(const RESULT &result);
+
+public:
+    JSDatabase();
+    ~JSDatabase();
+
+    void open(JQAsyncInfo &info);
+    void close(JQAsyncInfo &info);
+    void query(JQAsyncInfo &info);
+    void exec(JQAsyncInfo &info);
+    void queryBatch(JQAsyncInfo &info);
+    void execBatch(JQAsyncInfo &info);
+};
+
+JSValue createDatabase(JQModuleEnv *env);
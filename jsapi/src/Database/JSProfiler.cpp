@@ -0,0 +1,45 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "JSProfiler.hpp"
+
+static double toMillis(int64_t nanos) { return nanos / 1e6; }
+
+Bson JSProfiler::toBson(const PROFILER &profiler)
+{
+    // Counters can outgrow Bson's 32-bit integers, so every number goes out as a double
+    Bson::array statements;
+    for (const auto &metric : profiler.getMetrics())
+        statements.push_back(Bson::object{
+            {"sql", metric.sql},
+            {"calls", (double)metric.calls},
+            {"rows", (double)metric.rows},
+            {"cacheHits", (double)metric.cacheHits},
+            {"prepares", (double)metric.prepares},
+            {"prepareTime", toMillis(metric.prepareNanos)},
+            {"maxPrepareTime", toMillis(metric.maxPrepareNanos)},
+            {"stepTime", toMillis(metric.stepNanos)},
+            {"maxStepTime", toMillis(metric.maxStepNanos)}});
+    Bson::array slowStatements;
+    for (const auto &statement : profiler.getSlowStatements())
+        slowStatements.push_back(Bson::object{
+            {"sql", statement.sql},
+            {"stepTime", toMillis(statement.stepNanos)},
+            {"rows", (double)statement.rows},
+            {"timestamp", std::to_string(statement.timestamp)}});
+    return Bson::object{{"statements", statements}, {"slowStatements", slowStatements}};
+}
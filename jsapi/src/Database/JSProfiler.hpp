@@ -0,0 +1,30 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Profiler.hpp"
+#include <jqutil_v2/jqutil.h>
+
+using namespace JQUTIL_NS;
+
+// Snapshot of a PROFILER for diagnostics pages; times are in milliseconds
+class JSProfiler
+{
+public:
+    static Bson toBson(const PROFILER &profiler);
+};
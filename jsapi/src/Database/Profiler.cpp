@@ -0,0 +1,114 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+
+PROFILER::PROFILER(int slowMillis, size_t slowLogSize)
+    : slowNanos((int64_t)slowMillis * 1000000), slowLogSize(slowLogSize) {}
+
+void PROFILER::attach(sqlite3 *conn)
+{
+    ASSERT(conn != nullptr);
+    ASSERT_DATABASE_OK(sqlite3_trace_v2(conn, SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW, &PROFILER::onTrace, this));
+}
+
+PROFILER::METRICS &PROFILER::entry(const std::string &sql)
+{
+    METRICS &metric = metrics[sql];
+    if (metric.sql.empty())
+        metric.sql = sql;
+    return metric;
+}
+int PROFILER::onTrace(unsigned type, void *self, void *p, void *x)
+{
+    PROFILER *profiler = static_cast<PROFILER *>(self);
+    sqlite3_stmt *stmt = static_cast<sqlite3_stmt *>(p);
+    std::lock_guard<std::mutex> lock(profiler->metricsMutex);
+    if (type == SQLITE_TRACE_ROW)
+    {
+        // Statements SQLite runs internally (schema parsing) report rows without SQL text and never a profile
+        if (sqlite3_sql(stmt))
+            profiler->runningRows[stmt]++;
+        return 0;
+    }
+    // SQLITE_TRACE_PROFILE: one run of stmt has finished, x points at its wall time in nanoseconds
+    int64_t nanos = *static_cast<sqlite3_int64 *>(x);
+    uint64_t rows = 0;
+    auto it = profiler->runningRows.find(stmt);
+    if (it != profiler->runningRows.end())
+    {
+        rows = it->second;
+        profiler->runningRows.erase(it);
+    }
+    const char *sql = sqlite3_sql(stmt);
+    METRICS &metric = profiler->entry(sql ? sql : "");
+    metric.calls++;
+    metric.rows += rows;
+    metric.stepNanos += nanos;
+    metric.maxStepNanos = std::max(metric.maxStepNanos, nanos);
+    if (profiler->slowNanos > 0 && nanos >= profiler->slowNanos)
+    {
+        profiler->slowStatements.push_front({metric.sql, nanos, rows,
+                                             std::chrono::duration_cast<std::chrono::seconds>(
+                                                 std::chrono::system_clock::now().time_since_epoch())
+                                                 .count()});
+        if (profiler->slowStatements.size() > profiler->slowLogSize)
+            profiler->slowStatements.pop_back();
+    }
+    return 0;
+}
+
+void PROFILER::cacheHit(const std::string &sql)
+{
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    entry(sql).cacheHits++;
+}
+void PROFILER::prepared(const std::string &sql, int64_t nanos)
+{
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    METRICS &metric = entry(sql);
+    metric.prepares++;
+    metric.prepareNanos += nanos;
+    metric.maxPrepareNanos = std::max(metric.maxPrepareNanos, nanos);
+}
+
+std::vector<PROFILER::METRICS> PROFILER::getMetrics() const
+{
+    std::vector<METRICS> result;
+    {
+        std::lock_guard<std::mutex> lock(metricsMutex);
+        for (const auto &pair : metrics)
+            result.push_back(pair.second);
+    }
+    std::sort(result.begin(), result.end(),
+              [](const METRICS &a, const METRICS &b)
+              { return a.stepNanos > b.stepNanos; });
+    return result;
+}
+std::vector<PROFILER::SLOW_STATEMENT> PROFILER::getSlowStatements() const
+{
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    return std::vector<SLOW_STATEMENT>(slowStatements.begin(), slowStatements.end());
+}
+void PROFILER::reset()
+{
+    std::lock_guard<std::mutex> lock(metricsMutex);
+    metrics.clear();
+    slowStatements.clear();
+}
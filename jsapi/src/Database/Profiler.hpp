@@ -0,0 +1,77 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Includes.hpp"
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+// Per-statement timings collected with sqlite3_trace_v2, keyed by the SQL as written (parameters unexpanded),
+// so every execution of one builder shape lands in the same entry and bound values never reach the log.
+// Step times come from SQLite's profile clock, which only ticks in milliseconds on unix; compare totals, not single runs.
+class PROFILER
+{
+public:
+    struct METRICS
+    {
+        std::string sql;
+        uint64_t calls = 0;
+        uint64_t rows = 0;
+        uint64_t cacheHits = 0;
+        uint64_t prepares = 0;
+        int64_t prepareNanos = 0;
+        int64_t maxPrepareNanos = 0;
+        int64_t stepNanos = 0;
+        int64_t maxStepNanos = 0;
+    };
+    struct SLOW_STATEMENT
+    {
+        std::string sql;
+        int64_t stepNanos;
+        uint64_t rows;
+        int64_t timestamp; // seconds since the epoch
+    };
+
+private:
+    int64_t slowNanos;
+    size_t slowLogSize;
+    mutable std::mutex metricsMutex;
+    std::unordered_map<std::string, METRICS> metrics;
+    std::unordered_map<sqlite3_stmt *, uint64_t> runningRows;
+    std::deque<SLOW_STATEMENT> slowStatements;
+
+    METRICS &entry(const std::string &sql);
+    static int onTrace(unsigned type, void *self, void *p, void *x);
+
+public:
+    PROFILER(int slowMillis, size_t slowLogSize = 32);
+    PROFILER(const PROFILER &) = delete;
+    PROFILER &operator=(const PROFILER &) = delete;
+
+    // Starts tracing conn; keep the profiler alive until conn is closed
+    void attach(sqlite3 *conn);
+    // Reported by the statement cache, which sees what the trace hook cannot
+    void cacheHit(const std::string &sql);
+    void prepared(const std::string &sql, int64_t nanos);
+
+    std::vector<METRICS> getMetrics() const; // slowest total step time first
+    std::vector<SLOW_STATEMENT> getSlowStatements() const; // newest first
+    void reset();
+};
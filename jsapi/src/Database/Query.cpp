@@ -0,0 +1,50 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "Query.hpp"
+
+QUERY::QUERY(STATEMENT_CACHE *statements, std::string sql)
+    : statements(statements), conn(statements ? statements->connection() : nullptr), sql(sql)
+{
+    ASSERT(conn != nullptr);
+    ASSERT(!sql.empty());
+}
+QUERY &QUERY::bind(VALUE value)
+{
+    this->params.push_back(value);
+    return *this;
+}
+STATEMENT QUERY::prepare(sqlite3_destructor_type destructor) const
+{
+    STATEMENT stmt = statements->acquire(sql);
+    int idx = 1;
+    for (auto &param : params)
+        ASSERT_DATABASE_OK(bindValue(stmt, idx++, param, destructor));
+    return stmt;
+}
+RESULT QUERY::execute() const
+{
+    STATEMENT stmt = prepare(SQLITE_STATIC);
+    RESULT Data(stmt);
+    int res;
+    while ((res = sqlite3_step(stmt)) == SQLITE_ROW)
+        Data.append(stmt);
+    if (res != SQLITE_DONE)
+        THROW_DATABASE_ERROR(conn);
+    return Data;
+}
+CURSOR QUERY::cursor() const { return CURSOR(prepare(SQLITE_TRANSIENT), conn); }
@@ -0,0 +1,46 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Statement.hpp"
+#include "Value.hpp"
+#include "Result.hpp"
+#include "Cursor.hpp"
+#include <vector>
+
+class QUERY
+{
+private:
+    STATEMENT_CACHE *statements;
+    sqlite3 *conn;
+    std::string sql;
+    std::vector<VALUE> params;
+
+    STATEMENT prepare(sqlite3_destructor_type destructor) const;
+
+public:
+    QUERY(STATEMENT_CACHE *statements, std::string sql);
+    [[nodiscard]] QUERY &bind(VALUE value);
+    template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+    [[nodiscard]] QUERY &bind(T data)
+    {
+        return bind(toValue(data));
+    }
+    RESULT execute() const;
+    [[nodiscard]] CURSOR cursor() const;
+};
@@ -0,0 +1,142 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "Result.hpp"
+#include <cstdlib>
+
+RESULT::RESULT(sqlite3_stmt *stmt)
+{
+    ASSERT(stmt != nullptr);
+    int columnCount = sqlite3_column_count(stmt);
+    columnNames.reserve(columnCount);
+    for (int i = 0; i < columnCount; i++)
+        columnNames.push_back(sqlite3_column_name(stmt, i));
+}
+void RESULT::append(sqlite3_stmt *stmt)
+{
+    for (size_t i = 0; i < columnNames.size(); i++)
+    {
+        CELL cell;
+        cell.type = sqlite3_column_type(stmt, i);
+        cell.integer = 0;
+        cell.offset = data.size();
+        cell.length = 0;
+        switch (cell.type)
+        {
+        case SQLITE_INTEGER:
+            cell.integer = sqlite3_column_int64(stmt, i);
+            break;
+        case SQLITE_FLOAT:
+            cell.real = sqlite3_column_double(stmt, i);
+            break;
+        case SQLITE_TEXT:
+        case SQLITE_BLOB:
+        {
+            const void *bytes = cell.type == SQLITE_TEXT ? (const void *)sqlite3_column_text(stmt, i) : sqlite3_column_blob(stmt, i);
+            cell.length = sqlite3_column_bytes(stmt, i);
+            data.append(static_cast<const char *>(bytes), cell.length);
+            data.push_back('\0'); // lets getInt/getDouble parse text in place
+            break;
+        }
+        }
+        cells.push_back(cell);
+    }
+}
+
+void RESULT::clear()
+{
+    cells.clear();
+    data.clear();
+}
+
+const RESULT::CELL &RESULT::cell(size_t row, size_t column) const
+{
+    ASSERT(column < columnNames.size());
+    ASSERT(row < size());
+    return cells[row * columnNames.size() + column];
+}
+const std::string &RESULT::columnName(size_t column) const
+{
+    ASSERT(column < columnNames.size());
+    return columnNames[column];
+}
+size_t RESULT::column(const std::string &name) const
+{
+    for (size_t i = 0; i < columnNames.size(); i++)
+        if (columnNames[i] == name)
+            return i;
+    ASSERT(false);
+    return 0;
+}
+RESULT::ROW RESULT::operator[](size_t row) const
+{
+    ASSERT(row < size());
+    return ROW(this, row);
+}
+
+int RESULT::ROW::getType(size_t column) const { return result->cell(row, column).type; }
+bool RESULT::ROW::isNull(size_t column) const { return getType(column) == SQLITE_NULL; }
+int64_t RESULT::ROW::getInt(size_t column) const
+{
+    const CELL &cell = result->cell(row, column);
+    switch (cell.type)
+    {
+    case SQLITE_INTEGER:
+        return cell.integer;
+    case SQLITE_FLOAT:
+        return (int64_t)cell.real;
+    case SQLITE_TEXT:
+        return std::strtoll(result->data.data() + cell.offset, nullptr, 10);
+    default:
+        return 0;
+    }
+}
+double RESULT::ROW::getDouble(size_t column) const
+{
+    const CELL &cell = result->cell(row, column);
+    switch (cell.type)
+    {
+    case SQLITE_INTEGER:
+        return (double)cell.integer;
+    case SQLITE_FLOAT:
+        return cell.real;
+    case SQLITE_TEXT:
+        return std::strtod(result->data.data() + cell.offset, nullptr);
+    default:
+        return 0;
+    }
+}
+std::string_view RESULT::ROW::getText(size_t column) const
+{
+    const CELL &cell = result->cell(row, column);
+    ASSERT(cell.type != SQLITE_INTEGER && cell.type != SQLITE_FLOAT);
+    return std::string_view(result->data.data() + cell.offset, cell.length);
+}
+std::string_view RESULT::ROW::getBlob(size_t column) const { return getText(column); }
+std::string RESULT::ROW::getString(size_t column) const
+{
+    const CELL &cell = result->cell(row, column);
+    if (cell.type == SQLITE_INTEGER)
+        return std::to_string(cell.integer);
+    if (cell.type == SQLITE_FLOAT)
+    {
+        char buffer[32];
+        sqlite3_snprintf(sizeof(buffer), buffer, "%!.15g", cell.real);
+        return buffer;
+    }
+    return std::string(getText(column));
+}
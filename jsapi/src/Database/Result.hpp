@@ -0,0 +1,108 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Includes.hpp"
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+// Rows of a query stored as one array of typed cells, with the bytes of all
+// text and blob cells packed into a single buffer.
+class RESULT
+{
+private:
+    struct CELL
+    {
+        int type;
+        union
+        {
+            int64_t integer;
+            double real;
+        };
+        size_t offset;
+        size_t length;
+    };
+
+    std::vector<std::string> columnNames;
+    std::vector<CELL> cells;
+    std::string data;
+
+    const CELL &cell(size_t row, size_t column) const;
+
+public:
+    class ROW
+    {
+    private:
+        const RESULT *result;
+        size_t row;
+
+    public:
+        ROW(const RESULT *result, size_t row) : result(result), row(row) {}
+
+        size_t columnCount() const { return result->columnCount(); }
+        const std::string &columnName(size_t column) const { return result->columnName(column); }
+
+        int getType(size_t column) const;
+        bool isNull(size_t column) const;
+        int64_t getInt(size_t column) const;
+        double getDouble(size_t column) const;
+        std::string_view getText(size_t column) const;
+        std::string_view getBlob(size_t column) const;
+        std::string getString(size_t column) const; // any type, numbers formatted as SQLite would
+
+        bool isNull(const std::string &column) const { return isNull(result->column(column)); }
+        int64_t getInt(const std::string &column) const { return getInt(result->column(column)); }
+        double getDouble(const std::string &column) const { return getDouble(result->column(column)); }
+        std::string_view getText(const std::string &column) const { return getText(result->column(column)); }
+        std::string_view getBlob(const std::string &column) const { return getBlob(result->column(column)); }
+        std::string getString(const std::string &column) const { return getString(result->column(column)); }
+    };
+
+    class iterator
+    {
+    private:
+        const RESULT *result;
+        size_t row;
+
+    public:
+        iterator(const RESULT *result, size_t row) : result(result), row(row) {}
+        ROW operator*() const { return ROW(result, row); }
+        iterator &operator++()
+        {
+            row++;
+            return *this;
+        }
+        bool operator!=(const iterator &other) const { return row != other.row; }
+    };
+
+    RESULT() = default;
+    RESULT(sqlite3_stmt *stmt);
+    void append(sqlite3_stmt *stmt);
+    void clear();
+
+    size_t size() const { return columnNames.empty() ? 0 : cells.size() / columnNames.size(); }
+    bool empty() const { return cells.empty(); }
+    size_t columnCount() const { return columnNames.size(); }
+    const std::string &columnName(size_t column) const;
+    size_t column(const std::string &name) const;
+
+    ROW operator[](size_t row) const;
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, size()); }
+};
@@ -18,7 +18,8 @@
 #include "Select.hpp"
 #include <stdexcept>
 
-SELECT::SELECT(sqlite3 *conn, std::string tableName) : conn(conn), tableName(tableName)
+SELECT::SELECT(STATEMENT_CACHE *statements, std::string tableName)
+    : statements(statements), conn(statements ? statements->connection() : nullptr), tableName(tableName)
 {
     ASSERT(conn != nullptr);
     ASSERT(!tableName.empty());
@@ -29,11 +30,16 @@ SELECT &SELECT::select(std::string column)
     this->columns.push_back(column);
     return *this;
 }
-SELECT &SELECT::where(std::string column, std::string value)
+SELECT &SELECT::where(std::string column, VALUE value)
 {
     ASSERT(!column.empty());
-    ASSERT(!value.empty());
-    this->conditions.push_back({column, value});
+    ASSERT(!isEmptyValue(value));
+    this->conditions = this->conditions && WHERE::eq(column, value);
+    return *this;
+}
+SELECT &SELECT::where(const WHERE &predicate)
+{
+    this->conditions = this->conditions && predicate;
     return *this;
 }
 SELECT &SELECT::order(std::string column, bool ascending)
@@ -53,7 +59,7 @@ SELECT &SELECT::offset(size_t offsets)
     this->offsets = offsets;
     return *this;
 }
-std::vector<std::unordered_map<std::string, std::string>> SELECT::execute() const
+STATEMENT SELECT::prepare(sqlite3_destructor_type destructor) const
 {
     std::string query = "SELECT ";
     if (columns.empty())
@@ -66,12 +72,7 @@ std::vector<std::unordered_map<std::string, std::string>> SELECT::execute() cons
     }
     query += " FROM \"" + tableName + "\"";
     if (!conditions.empty())
-    {
-        query += " WHERE ";
-        for (auto &condition : conditions)
-            query += "\"" + condition.first + "\"=? AND ";
-        query.erase(query.end() - 5, query.end());
-    }
+        query += " WHERE " + conditions.toString();
     if (!orders.empty())
     {
         query += " ORDER BY ";
@@ -79,29 +80,30 @@ std::vector<std::unordered_map<std::string, std::string>> SELECT::execute() cons
             query += "\"" + Order.first + "\" " + (Order.second ? "ASC" : "DESC") + ", ";
         query.erase(query.end() - 2, query.end());
     }
-    if (limits)
-        query += " LIMIT " + std::to_string(limits);
+    // Bound rather than inlined so every page of a query shares one cached statement
+    if (limits || offsets)
+        query += " LIMIT ?";
     if (offsets)
-        query += " OFFSET " + std::to_string(offsets);
+        query += " OFFSET ?";
 
-    sqlite3_stmt *stmt = nullptr;
-    ASSERT_DATABASE_OK(sqlite3_prepare_v2(conn, query.c_str(), -1, &stmt, nullptr));
+    STATEMENT stmt = statements->acquire(query);
     int idx = 1;
-    for (auto &condition : conditions)
-        ASSERT_DATABASE_OK(sqlite3_bind_text(stmt, idx++, condition.second.c_str(), -1, SQLITE_TRANSIENT));
-    std::vector<std::unordered_map<std::string, std::string>> Data;
-    int colCount = columns.empty() ? sqlite3_column_count(stmt) : columns.size();
-    while (sqlite3_step(stmt) == SQLITE_ROW)
-    {
-        std::unordered_map<std::string, std::string> Row;
-        for (int i = 0; i < colCount; ++i)
-        {
-            std::string colName = columns.empty() ? sqlite3_column_name(stmt, i) : columns[i];
-            const unsigned char *val = sqlite3_column_text(stmt, i);
-            Row[colName] = val ? std::string(reinterpret_cast<const char *>(val)) : "";
-        }
-        Data.push_back(Row);
-    }
-    ASSERT_DATABASE_OK(sqlite3_finalize(stmt));
+    idx = conditions.bind(stmt, idx, destructor);
+    if (limits || offsets)
+        ASSERT_DATABASE_OK(sqlite3_bind_int64(stmt, idx++, limits ? (sqlite3_int64)limits : -1));
+    if (offsets)
+        ASSERT_DATABASE_OK(sqlite3_bind_int64(stmt, idx++, offsets));
+    return stmt;
+}
+RESULT SELECT::execute() const
+{
+    STATEMENT stmt = prepare(SQLITE_STATIC);
+    RESULT Data(stmt);
+    int res;
+    while ((res = sqlite3_step(stmt)) == SQLITE_ROW)
+        Data.append(stmt);
+    if (res != SQLITE_DONE)
+        THROW_DATABASE_ERROR(conn);
     return Data;
 }
+CURSOR SELECT::cursor() const { return CURSOR(prepare(SQLITE_TRANSIENT), conn); }
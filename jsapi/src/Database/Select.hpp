@@ -17,7 +17,11 @@
 
 #pragma once
 
-#include "Includes.hpp"
+#include "Statement.hpp"
+#include "Value.hpp"
+#include "Where.hpp"
+#include "Result.hpp"
+#include "Cursor.hpp"
 #include <vector>
 #include <functional>
 #include <unordered_map>
@@ -25,25 +29,30 @@
 class SELECT
 {
 private:
+    STATEMENT_CACHE *statements;
     sqlite3 *conn;
     std::string tableName;
     std::vector<std::string> columns;
-    std::vector<std::pair<std::string, std::string>> conditions;
+    WHERE conditions;
     std::vector<std::pair<std::string, bool>> orders;
     size_t limits = 0;
     size_t offsets = 0;
 
+    STATEMENT prepare(sqlite3_destructor_type destructor) const;
+
 public:
-    SELECT(sqlite3 *conn, std::string tableName);
+    SELECT(STATEMENT_CACHE *statements, std::string tableName);
     [[nodiscard]] SELECT &select(std::string column);
-    [[nodiscard]] SELECT &where(std::string column, std::string value);
+    [[nodiscard]] SELECT &where(std::string column, VALUE value);
     template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
     [[nodiscard]] SELECT &where(std::string column, T data)
     {
-        return where(column, std::to_string(data));
+        return where(column, toValue(data));
     }
+    [[nodiscard]] SELECT &where(const WHERE &predicate);
     [[nodiscard]] SELECT &order(std::string column, bool ascending);
     [[nodiscard]] SELECT &limit(size_t limits);
     [[nodiscard]] SELECT &offset(size_t offsets);
-    [[nodiscard]] std::vector<std::unordered_map<std::string, std::string>> execute() const;
+    [[nodiscard]] RESULT execute() const;
+    [[nodiscard]] CURSOR cursor() const;
 };
@@ -18,7 +18,8 @@
 #include "Size.hpp"
 #include <stdexcept>
 
-SIZE::SIZE(sqlite3 *conn, std::string tableName) : conn(conn), tableName(tableName)
+SIZE::SIZE(STATEMENT_CACHE *statements, std::string tableName)
+    : statements(statements), conn(statements ? statements->connection() : nullptr), tableName(tableName)
 {
     ASSERT(conn != nullptr);
     ASSERT(!tableName.empty());
@@ -26,10 +27,9 @@ SIZE::SIZE(sqlite3 *conn, std::string tableName) : conn(conn), tableName(tableNa
 int SIZE::execute() const
 {
     std::string query = "SELECT COUNT(*) FROM \"" + tableName + "\"";
-    sqlite3_stmt *stmt = nullptr;
-    ASSERT_DATABASE_OK(sqlite3_prepare_v2(conn, query.c_str(), -1, &stmt, nullptr));
-    ASSERT_DATABASE_OK(sqlite3_step(stmt));
+    STATEMENT stmt = statements->acquire(query);
+    if (sqlite3_step(stmt) != SQLITE_ROW)
+        THROW_DATABASE_ERROR(conn);
     int count = sqlite3_column_int(stmt, 0);
-    ASSERT_DATABASE_OK(sqlite3_finalize(stmt));
     return count;
 }
@@ -17,16 +17,17 @@
 
 #pragma once
 
-#include "Includes.hpp"
+#include "Statement.hpp"
 #include <functional>
 
 class SIZE
 {
 private:
+    STATEMENT_CACHE *statements;
     sqlite3 *conn;
     std::string tableName;
 
 public:
-    [[nodiscard]] SIZE(sqlite3 *conn, std::string tableName);
+    [[nodiscard]] SIZE(STATEMENT_CACHE *statements, std::string tableName);
     [[nodiscard]] int execute() const;
 };
@@ -0,0 +1,136 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "Statement.hpp"
+#include <chrono>
+
+STATEMENT::STATEMENT(std::unique_lock<std::recursive_mutex> connectionLock, STATEMENT_CACHE *cache, std::string sql, sqlite3_stmt *stmt)
+    : connectionLock(std::move(connectionLock)), cache(cache), sql(std::move(sql)), stmt(stmt) {}
+STATEMENT::STATEMENT(STATEMENT &&other) noexcept
+    : connectionLock(std::move(other.connectionLock)), cache(other.cache), sql(std::move(other.sql)), stmt(other.stmt)
+{
+    other.stmt = nullptr;
+}
+STATEMENT::~STATEMENT() { close(); }
+void STATEMENT::close()
+{
+    if (stmt)
+        cache->release(sql, stmt);
+    stmt = nullptr;
+    if (connectionLock.owns_lock())
+    {
+        cache->idle();
+        connectionLock.unlock();
+    }
+}
+
+STATEMENT_CACHE::STATEMENT_CACHE(sqlite3 *conn, size_t capacity) : conn(conn), capacity(capacity)
+{
+    ASSERT(conn != nullptr);
+}
+STATEMENT_CACHE::~STATEMENT_CACHE() { clear(); }
+
+STATEMENT STATEMENT_CACHE::acquire(const std::string &sql)
+{
+    std::unique_lock<std::recursive_mutex> connectionLock(connectionMutex);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = index.find(sql);
+        if (it != index.end())
+        {
+            sqlite3_stmt *stmt = it->second->second;
+            statements.erase(it->second);
+            index.erase(it);
+            hits++;
+            if (profiler)
+                profiler->cacheHit(sql);
+            return STATEMENT(std::move(connectionLock), this, sql, stmt);
+        }
+        misses++;
+    }
+    sqlite3_stmt *stmt = nullptr;
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_DATABASE_OK(sqlite3_prepare_v3(conn, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr));
+    if (profiler)
+        profiler->prepared(sql, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count());
+    return STATEMENT(std::move(connectionLock), this, sql, stmt);
+}
+void STATEMENT_CACHE::release(const std::string &sql, sqlite3_stmt *stmt)
+{
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (capacity == 0 || index.count(sql))
+    {
+        sqlite3_finalize(stmt);
+        return;
+    }
+    statements.emplace_front(sql, stmt);
+    index[sql] = statements.begin();
+    if (statements.size() > capacity)
+    {
+        index.erase(statements.back().first);
+        sqlite3_finalize(statements.back().second);
+        statements.pop_back();
+    }
+}
+void STATEMENT_CACHE::idle()
+{
+    if (transactionDepth == 0 && idleHook)
+        idleHook();
+}
+void STATEMENT_CACHE::onIdle(std::function<void()> hook)
+{
+    std::lock_guard<std::recursive_mutex> lock(connectionMutex);
+    idleHook = hook;
+}
+void STATEMENT_CACHE::setProfiler(PROFILER *profiler)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    this->profiler = profiler;
+}
+void STATEMENT_CACHE::setChangeFeed(CHANGE_FEED *changes)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    this->changes = changes;
+}
+void STATEMENT_CACHE::clear()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (auto &statement : statements)
+        sqlite3_finalize(statement.second);
+    statements.clear();
+    index.clear();
+}
+
+size_t STATEMENT_CACHE::getHits() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return hits;
+}
+size_t STATEMENT_CACHE::getMisses() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return misses;
+}
+size_t STATEMENT_CACHE::size() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return statements.size();
+}
@@ -0,0 +1,96 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Includes.hpp"
+#include "ChangeFeed.hpp"
+#include "Profiler.hpp"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <functional>
+#include <atomic>
+#include <thread>
+
+class STATEMENT_CACHE;
+
+// A prepared statement checked out of a STATEMENT_CACHE, handed back on destruction.
+// Holds the connection lock meanwhile so its steps are not interleaved with another thread's.
+class STATEMENT
+{
+private:
+    std::unique_lock<std::recursive_mutex> connectionLock;
+    STATEMENT_CACHE *cache;
+    std::string sql;
+    sqlite3_stmt *stmt;
+
+public:
+    STATEMENT(std::unique_lock<std::recursive_mutex> connectionLock, STATEMENT_CACHE *cache, std::string sql, sqlite3_stmt *stmt);
+    STATEMENT(STATEMENT &&other) noexcept;
+    STATEMENT(const STATEMENT &) = delete;
+    STATEMENT &operator=(const STATEMENT &) = delete;
+    ~STATEMENT();
+
+    void close(); // hands the statement back early
+    operator sqlite3_stmt *() const { return stmt; }
+};
+
+// LRU of prepared statements keyed by their SQL text. A statement is removed
+// while checked out, so concurrent users of the same SQL each get their own.
+class STATEMENT_CACHE
+{
+private:
+    sqlite3 *conn;
+    size_t capacity;
+    std::list<std::pair<std::string, sqlite3_stmt *>> statements;
+    std::unordered_map<std::string, std::list<std::pair<std::string, sqlite3_stmt *>>::iterator> index;
+    size_t hits = 0;
+    size_t misses = 0;
+    mutable std::mutex cacheMutex;
+    std::recursive_mutex connectionMutex;
+    int transactionDepth = 0;
+    std::atomic<std::thread::id> transactionOwner{std::thread::id()};
+    std::function<void()> idleHook;
+    PROFILER *profiler = nullptr;
+    CHANGE_FEED *changes = nullptr;
+
+    friend class STATEMENT;
+    friend class TRANSACTION;
+    void release(const std::string &sql, sqlite3_stmt *stmt);
+    void idle();
+
+public:
+    STATEMENT_CACHE(sqlite3 *conn, size_t capacity = 32);
+    STATEMENT_CACHE(const STATEMENT_CACHE &) = delete;
+    STATEMENT_CACHE &operator=(const STATEMENT_CACHE &) = delete;
+    ~STATEMENT_CACHE();
+
+    sqlite3 *connection() const { return conn; }
+    STATEMENT acquire(const std::string &sql);
+    void clear();
+    // Runs whenever a statement or transaction finishes and no transaction is left open on the connection
+    void onIdle(std::function<void()> hook);
+    void setProfiler(PROFILER *profiler);
+    void setChangeFeed(CHANGE_FEED *changes);
+    // Whether the calling thread has a transaction open on this connection
+    bool inTransaction() const { return transactionOwner == std::this_thread::get_id(); }
+
+    size_t getHits() const;
+    size_t getMisses() const;
+    size_t size() const;
+};
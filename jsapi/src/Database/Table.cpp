@@ -60,6 +60,27 @@ TABLE &TABLE::column(std::string name, ColumnType type, int options, std::string
     return *this;
 }
 
+TABLE &TABLE::index(std::vector<std::string> columns, int options, std::string where)
+{
+    ASSERT(!columns.empty());
+    ASSERT((options & ~UNIQUE) == 0);
+    std::string indexName = "idx_" + tableName;
+    std::string indexColumns;
+    for (auto &column : columns)
+    {
+        ASSERT(!column.empty());
+        indexName += "_" + column;
+        indexColumns += "\"" + column + "\", ";
+    }
+    indexColumns.erase(indexColumns.end() - 2, indexColumns.end());
+    std::string indexDefinition = std::string("CREATE ") + (options & UNIQUE ? "UNIQUE " : "") +
+                                  "INDEX IF NOT EXISTS \"" + indexName + "\" ON \"" + tableName + "\" (" + indexColumns + ")";
+    if (!where.empty())
+        indexDefinition += " WHERE " + where;
+    indexes.push_back(indexDefinition);
+    return *this;
+}
+
 void TABLE::execute() const
 {
     std::string sql = "CREATE TABLE IF NOT EXISTS " + std::string(tableName) + " (";
@@ -72,4 +93,7 @@ void TABLE::execute() const
     sql += ")";
 
     ASSERT_DATABASE_OK(sqlite3_exec(conn, sql.c_str(), nullptr, nullptr, nullptr));
+
+    for (auto &index : indexes)
+        ASSERT_DATABASE_OK(sqlite3_exec(conn, index.c_str(), nullptr, nullptr, nullptr));
 }
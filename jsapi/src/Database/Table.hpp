@@ -29,6 +29,7 @@ private:
     sqlite3 *conn;
     std::string tableName;
     std::vector<std::string> columns;
+    std::vector<std::string> indexes;
 
 public:
     enum ColumnType
@@ -49,5 +50,7 @@ public:
 
     TABLE(sqlite3 *conn, std::string tableName);
     [[nodiscard]] TABLE &column(std::string name, ColumnType type = TEXT, int options = 0, std::string defaultValue = "");
+    // options accepts UNIQUE, a non-empty where makes it a partial index
+    [[nodiscard]] TABLE &index(std::vector<std::string> columns, int options = 0, std::string where = "");
     void execute() const;
 };
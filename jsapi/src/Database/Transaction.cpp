@@ -0,0 +1,74 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "Transaction.hpp"
+
+TRANSACTION::TRANSACTION(STATEMENT_CACHE *statements)
+    : statements(statements), conn(statements ? statements->connection() : nullptr)
+{
+    ASSERT(conn != nullptr);
+    connectionLock = std::unique_lock<std::recursive_mutex>(statements->connectionMutex);
+    depth = statements->transactionDepth;
+    if (depth > 0 && statements->changes)
+        changeMark = statements->changes->mark();
+    run(depth == 0 ? "BEGIN IMMEDIATE" : "SAVEPOINT sp" + std::to_string(depth));
+    statements->transactionDepth++;
+    statements->transactionOwner = std::this_thread::get_id();
+}
+TRANSACTION::~TRANSACTION()
+{
+    if (finished)
+        return;
+    try
+    {
+        rollback();
+    }
+    catch (const std::exception &)
+    {
+    }
+}
+
+void TRANSACTION::run(const std::string &sql)
+{
+    ASSERT_DATABASE_OK(sqlite3_exec(conn, sql.c_str(), nullptr, nullptr, nullptr));
+}
+void TRANSACTION::commit()
+{
+    ASSERT(!finished);
+    run(depth == 0 ? "COMMIT" : "RELEASE sp" + std::to_string(depth));
+    finished = true;
+    if (--statements->transactionDepth == 0)
+        statements->transactionOwner = std::thread::id();
+    statements->idle();
+}
+void TRANSACTION::rollback()
+{
+    ASSERT(!finished);
+    finished = true;
+    if (--statements->transactionDepth == 0)
+        statements->transactionOwner = std::thread::id();
+    if (depth == 0)
+        run("ROLLBACK");
+    else
+    {
+        run("ROLLBACK TO sp" + std::to_string(depth) + "; RELEASE sp" + std::to_string(depth));
+        // The update hook already saw the undone rows and SQLite has no hook for ROLLBACK TO
+        if (statements->changes)
+            statements->changes->rewind(changeMark);
+    }
+    statements->idle();
+}
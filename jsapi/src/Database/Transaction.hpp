@@ -0,0 +1,46 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Statement.hpp"
+
+// Scoped transaction: commit() makes it permanent and throws if that fails;
+// going out of scope without commit() rolls it back. Nested guards on one
+// connection become savepoints. The connection stays locked to the owning
+// thread until then.
+class TRANSACTION
+{
+private:
+    std::unique_lock<std::recursive_mutex> connectionLock;
+    STATEMENT_CACHE *statements;
+    sqlite3 *conn;
+    int depth;
+    size_t changeMark = 0;
+    bool finished = false;
+
+    void run(const std::string &sql);
+
+public:
+    TRANSACTION(STATEMENT_CACHE *statements);
+    TRANSACTION(const TRANSACTION &) = delete;
+    TRANSACTION &operator=(const TRANSACTION &) = delete;
+    ~TRANSACTION();
+
+    void commit();
+    void rollback();
+};
@@ -18,20 +18,26 @@
 #include "Update.hpp"
 #include <stdexcept>
 
-UPDATE::UPDATE(sqlite3 *conn, std::string tableName) : conn(conn), tableName(tableName)
+UPDATE::UPDATE(STATEMENT_CACHE *statements, std::string tableName)
+    : statements(statements), conn(statements ? statements->connection() : nullptr), tableName(tableName)
 {
     ASSERT(conn != nullptr);
     ASSERT(!tableName.empty());
 }
-UPDATE &UPDATE::set(std::string column, std::string value)
+UPDATE &UPDATE::set(std::string column, VALUE value)
 {
     ASSERT(!column.empty());
     this->columns.push_back({column, value});
     return *this;
 }
-UPDATE &UPDATE::where(std::string column, std::string value)
+UPDATE &UPDATE::where(std::string column, VALUE value)
 {
-    this->conditions.push_back({column, value});
+    this->conditions = this->conditions && WHERE::eq(column, value);
+    return *this;
+}
+UPDATE &UPDATE::where(const WHERE &predicate)
+{
+    this->conditions = this->conditions && predicate;
     return *this;
 }
 void UPDATE::execute() const
@@ -41,19 +47,11 @@ void UPDATE::execute() const
         query += "\"" + column.first + "\"=?, ";
     query.erase(query.end() - 2, query.end());
     if (!conditions.empty())
-    {
-        query += " WHERE ";
-        for (auto &condition : conditions)
-            query += "\"" + condition.first + "\"=? AND ";
-        query.erase(query.end() - 5, query.end());
-    }
-    sqlite3_stmt *stmt = nullptr;
-    ASSERT_DATABASE_OK(sqlite3_prepare_v2(conn, query.c_str(), -1, &stmt, nullptr));
+        query += " WHERE " + conditions.toString();
+    STATEMENT stmt = statements->acquire(query);
     int idx = 1;
     for (auto &column : columns)
-        ASSERT_DATABASE_OK(sqlite3_bind_text(stmt, idx++, column.second.c_str(), -1, SQLITE_TRANSIENT));
-    for (auto &condition : conditions)
-        ASSERT_DATABASE_OK(sqlite3_bind_text(stmt, idx++, condition.second.c_str(), -1, SQLITE_TRANSIENT));
+        ASSERT_DATABASE_OK(bindValue(stmt, idx++, column.second, SQLITE_STATIC));
+    idx = conditions.bind(stmt, idx, SQLITE_STATIC);
     ASSERT_DATABASE_OK(sqlite3_step(stmt));
-    ASSERT_DATABASE_OK(sqlite3_finalize(stmt));
 }
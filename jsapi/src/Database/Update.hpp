@@ -17,30 +17,34 @@
 
 #pragma once
 
-#include "Includes.hpp"
+#include "Statement.hpp"
+#include "Value.hpp"
+#include "Where.hpp"
 #include <vector>
 
 class UPDATE
 {
 private:
+    STATEMENT_CACHE *statements;
     sqlite3 *conn;
     std::string tableName;
-    std::vector<std::pair<std::string, std::string>> columns;
-    std::vector<std::pair<std::string, std::string>> conditions;
+    std::vector<std::pair<std::string, VALUE>> columns;
+    WHERE conditions;
 
 public:
-    UPDATE(sqlite3 *conn, std::string tableName);
-    [[nodiscard]] UPDATE &set(std::string col, std::string value);
+    UPDATE(STATEMENT_CACHE *statements, std::string tableName);
+    [[nodiscard]] UPDATE &set(std::string col, VALUE value);
     template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
     [[nodiscard]] UPDATE &set(std::string column, T data)
     {
-        return set(column, std::to_string(data));
+        return set(column, toValue(data));
     }
-    [[nodiscard]] UPDATE &where(std::string col, std::string value);
+    [[nodiscard]] UPDATE &where(std::string col, VALUE value);
     template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
     [[nodiscard]] UPDATE &where(std::string column, T data)
     {
-        return where(column, std::to_string(data));
+        return where(column, toValue(data));
     }
+    [[nodiscard]] UPDATE &where(const WHERE &predicate);
     void execute() const;
 };
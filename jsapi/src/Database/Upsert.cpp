@@ -0,0 +1,84 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "Upsert.hpp"
+
+UPSERT::UPSERT(STATEMENT_CACHE *statements, std::string tableName)
+    : statements(statements), conn(statements ? statements->connection() : nullptr), tableName(tableName)
+{
+    ASSERT(conn != nullptr);
+    ASSERT(!tableName.empty());
+}
+UPSERT &UPSERT::value(std::string column, VALUE data)
+{
+    ASSERT(!column.empty());
+    this->columns.push_back(column);
+    this->values.push_back(data);
+    return *this;
+}
+UPSERT &UPSERT::conflict(std::string column)
+{
+    ASSERT(!column.empty());
+    this->conflictColumns.push_back(column);
+    return *this;
+}
+UPSERT &UPSERT::update(std::string column)
+{
+    return update(column, "excluded.\"" + column + "\"");
+}
+UPSERT &UPSERT::update(std::string column, std::string expression, std::vector<VALUE> parameters)
+{
+    ASSERT(!column.empty());
+    ASSERT(!expression.empty());
+    this->assignments.push_back({column, expression});
+    for (auto &parameter : parameters)
+        this->assignmentValues.push_back(parameter);
+    return *this;
+}
+void UPSERT::execute() const
+{
+    ASSERT(!columns.empty());
+    ASSERT(!conflictColumns.empty());
+    std::string query = "INSERT INTO \"" + tableName + "\" (";
+    for (auto &column : columns)
+        query += "\"" + column + "\", ";
+    query.erase(query.end() - 2, query.end());
+    query += ") VALUES (";
+    for (size_t i = 0; i < values.size(); i++)
+        query += "?, ";
+    query.erase(query.end() - 2, query.end());
+    query += ") ON CONFLICT (";
+    for (auto &column : conflictColumns)
+        query += "\"" + column + "\", ";
+    query.erase(query.end() - 2, query.end());
+    if (assignments.empty())
+        query += ") DO NOTHING";
+    else
+    {
+        query += ") DO UPDATE SET ";
+        for (auto &assignment : assignments)
+            query += "\"" + assignment.first + "\" = " + assignment.second + ", ";
+        query.erase(query.end() - 2, query.end());
+    }
+    STATEMENT stmt = statements->acquire(query);
+    int idx = 1;
+    for (auto &value : values)
+        ASSERT_DATABASE_OK(bindValue(stmt, idx++, value, SQLITE_STATIC));
+    for (auto &value : assignmentValues)
+        ASSERT_DATABASE_OK(bindValue(stmt, idx++, value, SQLITE_STATIC));
+    ASSERT_DATABASE_OK(sqlite3_step(stmt));
+}
@@ -0,0 +1,53 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Statement.hpp"
+#include "Value.hpp"
+#include <vector>
+
+// INSERT ... ON CONFLICT(...) DO UPDATE SET ..., executed as one statement.
+// Without any update() the conflicting row is left untouched (DO NOTHING).
+class UPSERT
+{
+private:
+    STATEMENT_CACHE *statements;
+    sqlite3 *conn;
+    std::string tableName;
+    std::vector<std::string> columns;
+    std::vector<VALUE> values;
+    std::vector<std::string> conflictColumns;
+    std::vector<std::pair<std::string, std::string>> assignments;
+    std::vector<VALUE> assignmentValues;
+
+public:
+    UPSERT(STATEMENT_CACHE *statements, std::string tableName);
+    [[nodiscard]] UPSERT &value(std::string column, VALUE data);
+    template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+    [[nodiscard]] UPSERT &value(std::string column, T data)
+    {
+        return value(column, toValue(data));
+    }
+    [[nodiscard]] UPSERT &conflict(std::string column);
+    // Overwrite column with the value that was about to be inserted
+    [[nodiscard]] UPSERT &update(std::string column);
+    // Set column to an SQL expression, e.g. update("freq", "\"freq\" + ?", {100}); the existing row is addressed by
+    // bare column names, the rejected one by excluded."column"
+    [[nodiscard]] UPSERT &update(std::string column, std::string expression, std::vector<VALUE> parameters = {});
+    void execute() const;
+};
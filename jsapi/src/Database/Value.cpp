@@ -0,0 +1,43 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "Value.hpp"
+
+int bindValue(sqlite3_stmt *stmt, int index, const VALUE &value, sqlite3_destructor_type destructor)
+{
+    switch (value.index())
+    {
+    case 1:
+        return sqlite3_bind_int64(stmt, index, std::get<int64_t>(value));
+    case 2:
+        return sqlite3_bind_double(stmt, index, std::get<double>(value));
+    case 3:
+    {
+        const std::string &text = std::get<std::string>(value);
+        return sqlite3_bind_text(stmt, index, text.c_str(), text.size(), destructor);
+    }
+    case 4:
+    {
+        const std::vector<uint8_t> &blob = std::get<std::vector<uint8_t>>(value);
+        if (blob.empty())
+            return sqlite3_bind_zeroblob(stmt, index, 0);
+        return sqlite3_bind_blob(stmt, index, blob.data(), blob.size(), destructor);
+    }
+    default:
+        return sqlite3_bind_null(stmt, index);
+    }
+}
@@ -0,0 +1,45 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Includes.hpp"
+#include <vector>
+#include <cstdint>
+#include <variant>
+#include <type_traits>
+
+// A value bound to a statement parameter with its native SQLite type
+using VALUE = std::variant<std::nullptr_t, int64_t, double, std::string, std::vector<uint8_t>>;
+
+template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+VALUE toValue(T data)
+{
+    if constexpr (std::is_integral_v<T>)
+        return (int64_t)data;
+    else
+        return (double)data;
+}
+inline VALUE toValue(VALUE data) { return data; }
+inline bool isEmptyValue(const VALUE &value)
+{
+    return std::holds_alternative<std::nullptr_t>(value) ||
+           (std::holds_alternative<std::string>(value) && std::get<std::string>(value).empty());
+}
+
+// SQLITE_STATIC when the value outlives every step of the statement, SQLITE_TRANSIENT otherwise
+int bindValue(sqlite3_stmt *stmt, int index, const VALUE &value, sqlite3_destructor_type destructor);
@@ -0,0 +1,103 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "Where.hpp"
+
+WHERE::WHERE(PRECEDENCE precedence, std::string sql, std::vector<VALUE> values)
+    : precedence(precedence), sql(sql), values(values) {}
+WHERE WHERE::compare(const std::string &column, const char *op, VALUE value)
+{
+    ASSERT(!column.empty());
+    ASSERT(!std::holds_alternative<std::nullptr_t>(value));
+    return WHERE(ATOM, "\"" + column + "\" " + op + " ?", {value});
+}
+WHERE WHERE::combine(const WHERE &left, const WHERE &right, PRECEDENCE precedence)
+{
+    if (left.empty())
+        return right;
+    if (right.empty())
+        return left;
+    auto operand = [precedence](const WHERE &where)
+    { return where.precedence > precedence ? "(" + where.sql + ")" : where.sql; };
+    std::vector<VALUE> values = left.values;
+    values.insert(values.end(), right.values.begin(), right.values.end());
+    return WHERE(precedence, operand(left) + (precedence == AND ? " AND " : " OR ") + operand(right), values);
+}
+
+WHERE WHERE::between(const std::string &column, VALUE low, VALUE high)
+{
+    ASSERT(!column.empty());
+    return WHERE(ATOM, "\"" + column + "\" BETWEEN ? AND ?", {low, high});
+}
+WHERE WHERE::in(const std::string &column, const std::vector<VALUE> &list)
+{
+    ASSERT(!column.empty());
+    if (list.empty())
+        return WHERE(ATOM, "0", {});
+    std::string sql = "\"" + column + "\" IN (";
+    for (size_t i = 0; i < list.size(); i++)
+        sql += "?, ";
+    sql.erase(sql.end() - 2, sql.end());
+    sql += ")";
+    return WHERE(ATOM, sql, list);
+}
+WHERE WHERE::prefix(const std::string &column, const std::string &start)
+{
+    ASSERT(!column.empty());
+    if (start.empty())
+        return notNull(column);
+    // The smallest string greater than every string starting with start: bump the last byte that can be bumped
+    std::string successor = start;
+    while (!successor.empty() && (unsigned char)successor.back() == 0xFF)
+        successor.pop_back();
+    if (successor.empty())
+        return ge(column, start);
+    successor.back()++;
+    return WHERE(AND, "\"" + column + "\" >= ? AND \"" + column + "\" < ?", {start, successor});
+}
+WHERE WHERE::like(const std::string &column, const std::string &pattern)
+{
+    ASSERT(!column.empty());
+    return WHERE(ATOM, "\"" + column + "\" LIKE ? ESCAPE '\\'", {pattern});
+}
+WHERE WHERE::isNull(const std::string &column)
+{
+    ASSERT(!column.empty());
+    return WHERE(ATOM, "\"" + column + "\" IS NULL", {});
+}
+WHERE WHERE::notNull(const std::string &column)
+{
+    ASSERT(!column.empty());
+    return WHERE(ATOM, "\"" + column + "\" IS NOT NULL", {});
+}
+
+WHERE WHERE::operator&&(const WHERE &other) const { return combine(*this, other, AND); }
+WHERE WHERE::operator||(const WHERE &other) const { return combine(*this, other, OR); }
+
+bool WHERE::empty() const { return precedence == NONE; }
+const std::string &WHERE::toString() const { return sql; }
+const std::vector<VALUE> &WHERE::getValues() const { return values; }
+int WHERE::bind(sqlite3_stmt *stmt, int index, sqlite3_destructor_type destructor) const
+{
+    for (const auto &value : values)
+    {
+        int res = bindValue(stmt, index++, value, destructor);
+        if (res != SQLITE_OK)
+            THROW_DATABASE_ERROR(sqlite3_db_handle(stmt));
+    }
+    return index;
+}
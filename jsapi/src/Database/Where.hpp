@@ -0,0 +1,87 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Value.hpp"
+#include <vector>
+
+// A parameterized WHERE predicate. Predicates combine with && and ||; every value is bound, never inlined,
+// so the SQL text only depends on the shape of the predicate and the statement cache can reuse it.
+class WHERE
+{
+private:
+    enum PRECEDENCE
+    {
+        NONE,
+        ATOM,
+        AND,
+        OR,
+    };
+    PRECEDENCE precedence = NONE;
+    std::string sql;
+    std::vector<VALUE> values;
+
+    WHERE(PRECEDENCE precedence, std::string sql, std::vector<VALUE> values);
+    static WHERE compare(const std::string &column, const char *op, VALUE value);
+    static WHERE combine(const WHERE &left, const WHERE &right, PRECEDENCE precedence);
+
+public:
+    WHERE() = default;
+
+    template <typename T>
+    static WHERE eq(const std::string &column, T value) { return compare(column, "=", toValue(value)); }
+    template <typename T>
+    static WHERE ne(const std::string &column, T value) { return compare(column, "!=", toValue(value)); }
+    template <typename T>
+    static WHERE lt(const std::string &column, T value) { return compare(column, "<", toValue(value)); }
+    template <typename T>
+    static WHERE le(const std::string &column, T value) { return compare(column, "<=", toValue(value)); }
+    template <typename T>
+    static WHERE gt(const std::string &column, T value) { return compare(column, ">", toValue(value)); }
+    template <typename T>
+    static WHERE ge(const std::string &column, T value) { return compare(column, ">=", toValue(value)); }
+    template <typename T>
+    static WHERE between(const std::string &column, T low, T high) { return between(column, toValue(low), toValue(high)); }
+    static WHERE between(const std::string &column, VALUE low, VALUE high);
+    // An empty list matches nothing
+    template <typename T>
+    static WHERE in(const std::string &column, const std::vector<T> &list)
+    {
+        std::vector<VALUE> converted;
+        converted.reserve(list.size());
+        for (const auto &item : list)
+            converted.push_back(toValue(item));
+        return in(column, converted);
+    }
+    static WHERE in(const std::string &column, const std::vector<VALUE> &list);
+    // Rewritten to a [start, successor) range so the lookup can seek an index; LIKE 'prefix%' cannot
+    static WHERE prefix(const std::string &column, const std::string &start);
+    // pattern uses % and _, escaped with a backslash
+    static WHERE like(const std::string &column, const std::string &pattern);
+    static WHERE isNull(const std::string &column);
+    static WHERE notNull(const std::string &column);
+
+    WHERE operator&&(const WHERE &other) const;
+    WHERE operator||(const WHERE &other) const;
+
+    bool empty() const;
+    const std::string &toString() const;
+    const std::vector<VALUE> &getValues() const;
+    // Binds every value starting at index and returns the next free index
+    int bind(sqlite3_stmt *stmt, int index, sqlite3_destructor_type destructor) const;
+};
@@ -0,0 +1,118 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "Writer.hpp"
+#include "Transaction.hpp"
+
+WRITER::WRITER(STATEMENT_CACHE *statements, size_t capacity)
+    : statements(statements), capacity(capacity)
+{
+    ASSERT(statements != nullptr);
+    ASSERT(capacity > 0);
+    thread = std::thread(&WRITER::run, this);
+}
+WRITER::~WRITER()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobsMutex);
+        stopping = true;
+    }
+    jobsCondition.notify_all();
+    thread.join();
+}
+
+void WRITER::fail(JOB &job, std::exception_ptr error)
+{
+    if (job.failed)
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch (const std::exception &e)
+        {
+            job.failed(e.what());
+        }
+        catch (...)
+        {
+            job.failed("Unknown error");
+        }
+    job.done.set_exception(error);
+}
+
+std::future<void> WRITER::post(std::function<void()> work, WRITE_ERROR_CALLBACK failed)
+{
+    ASSERT(work != nullptr);
+    JOB job{work, std::promise<void>(), failed};
+    std::future<void> future = job.done.get_future();
+    std::unique_lock<std::mutex> lock(jobsMutex);
+    ASSERT(!stopping);
+    if (jobs.size() >= capacity)
+    {
+        lock.unlock();
+        fail(job, std::make_exception_ptr(Exception(__FILE__, __LINE__, "Write queue is full")));
+        return future;
+    }
+    jobs.push_back(std::move(job));
+    lock.unlock();
+    jobsCondition.notify_all();
+    return future;
+}
+
+void WRITER::run()
+{
+    while (true)
+    {
+        std::deque<JOB> batch;
+        {
+            std::unique_lock<std::mutex> lock(jobsMutex);
+            jobsCondition.wait(lock, [this]()
+                               { return stopping || !jobs.empty(); });
+            if (jobs.empty())
+                return;
+            batch.swap(jobs);
+        }
+
+        std::vector<std::exception_ptr> errors(batch.size());
+        try
+        {
+            TRANSACTION transaction(statements);
+            for (size_t i = 0; i < batch.size(); i++)
+                try
+                {
+                    TRANSACTION savepoint(statements);
+                    batch[i].work();
+                    savepoint.commit();
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+            transaction.commit();
+        }
+        catch (...)
+        {
+            for (auto &error : errors)
+                if (!error)
+                    error = std::current_exception();
+        }
+        for (size_t i = 0; i < batch.size(); i++)
+            if (errors[i])
+                fail(batch[i], errors[i]);
+            else
+                batch[i].done.set_value();
+    }
+}
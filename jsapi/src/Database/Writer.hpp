@@ -0,0 +1,61 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Statement.hpp"
+#include <deque>
+#include <future>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+// Runs writes on a thread of its own. Whatever is queued when the thread wakes up is applied in one
+// transaction, each write inside its own savepoint so a failing one is rolled back alone.
+// A write's future is fulfilled only after the transaction holding it has committed.
+using WRITE_ERROR_CALLBACK = std::function<void(const std::string &error)>;
+class WRITER
+{
+private:
+    struct JOB
+    {
+        std::function<void()> work;
+        std::promise<void> done;
+        WRITE_ERROR_CALLBACK failed;
+    };
+
+    STATEMENT_CACHE *statements;
+    size_t capacity;
+    std::deque<JOB> jobs;
+    std::mutex jobsMutex;
+    std::condition_variable jobsCondition;
+    bool stopping = false;
+    std::thread thread;
+
+    void run();
+    static void fail(JOB &job, std::exception_ptr error);
+
+public:
+    WRITER(STATEMENT_CACHE *statements, size_t capacity);
+    WRITER(const WRITER &) = delete;
+    WRITER &operator=(const WRITER &) = delete;
+    ~WRITER(); // applies everything still queued before returning
+
+    // Never blocks: with capacity writes already waiting the write is rejected instead, it may come from a
+    // synchronous JS call. failed, when given, also receives every error, for callers that drop the future.
+    std::future<void> post(std::function<void()> work, WRITE_ERROR_CALLBACK failed = nullptr);
+};
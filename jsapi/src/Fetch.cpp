@@ -19,6 +19,23 @@
 #include "strUtils.hpp"
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <fstream>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static std::string findHeader(const std::unordered_map<std::string, std::string> &headers, const std::string &name)
+{
+    for (const auto &pair : headers)
+        if (strcasecmp(pair.first.c_str(), name.c_str()) == 0)
+            return pair.second;
+    return "";
+}
 
 Response::Response(int status, std::string body) : status(status), body(body), ok(status >= 200 && status < 300) {}
 nlohmann::json Response::json()
@@ -34,6 +51,264 @@ nlohmann::json Response::json()
 }
 std::string Response::text() { return body; }
 bool Response::isOk() { return ok; }
+std::string Response::header(const std::string &name) const { return findHeader(headers, name); }
+
+ConnectionPool::ConnectionPool() : share(curl_share_init())
+{
+    if (!share)
+        THROW_CURL_ERROR(CURLE_FAILED_INIT);
+    curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lock);
+    curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlock);
+    curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+ConnectionPool::~ConnectionPool()
+{
+    for (auto &host : idle)
+        for (auto &handle : host.second)
+            curl_easy_cleanup(handle.curl);
+    curl_share_cleanup(share);
+}
+void ConnectionPool::lock(CURL *curl, curl_lock_data data, curl_lock_access access, void *userptr)
+{
+    static_cast<ConnectionPool *>(userptr)->shareLocks[data].lock();
+}
+void ConnectionPool::unlock(CURL *curl, curl_lock_data data, void *userptr)
+{
+    static_cast<ConnectionPool *>(userptr)->shareLocks[data].unlock();
+}
+void ConnectionPool::evictExpired(std::chrono::steady_clock::time_point now)
+{
+    for (auto host = idle.begin(); host != idle.end();)
+    {
+        auto &handles = host->second;
+        auto expired = std::remove_if(handles.begin(), handles.end(), [&](const IdleHandle &handle)
+                                      {
+                                          if (now - handle.since < IDLE_TIMEOUT)
+                                              return false;
+                                          curl_easy_cleanup(handle.curl);
+                                          return true; });
+        idleCount -= handles.end() - expired;
+        handles.erase(expired, handles.end());
+        host = handles.empty() ? idle.erase(host) : std::next(host);
+    }
+}
+std::string ConnectionPool::origin(const std::string &url)
+{
+    size_t schemeEnd = url.find("://");
+    size_t hostStart = schemeEnd == std::string::npos ? 0 : schemeEnd + 3;
+    size_t hostEnd = url.find_first_of("/?#", hostStart);
+    return url.substr(0, hostEnd);
+}
+CURL *ConnectionPool::acquire(const std::string &origin)
+{
+    CURL *curl = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        evictExpired(std::chrono::steady_clock::now());
+        auto host = idle.find(origin);
+        if (host != idle.end())
+        {
+            // Most recently used first, its connection is the least likely to have been closed by the server
+            curl = host->second.back().curl;
+            host->second.pop_back();
+            idleCount--;
+            if (host->second.empty())
+                idle.erase(host);
+        }
+    }
+    if (!curl)
+        curl = curl_easy_init();
+    if (!curl)
+        THROW_CURL_ERROR(CURLE_FAILED_INIT);
+
+    ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_SHARE, share));
+    ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_MAXCONNECTS, MAX_CONNECTIONS_PER_HANDLE));
+    ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L));
+#if LIBCURL_VERSION_NUM >= 0x074100
+    ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_MAXAGE_CONN, (long)IDLE_TIMEOUT.count()));
+#endif
+    return curl;
+}
+void ConnectionPool::release(const std::string &origin, CURL *curl, bool reusable)
+{
+    if (reusable)
+    {
+        // Drops the options of the last request but keeps its connections and caches
+        curl_easy_reset(curl);
+        std::lock_guard<std::mutex> guard(mutex);
+        auto now = std::chrono::steady_clock::now();
+        evictExpired(now);
+        auto &handles = idle[origin];
+        if (handles.size() < MAX_IDLE_PER_HOST && idleCount < MAX_IDLE)
+        {
+            handles.push_back({curl, now});
+            idleCount++;
+            return;
+        }
+        if (handles.empty())
+            idle.erase(origin);
+    }
+    curl_easy_cleanup(curl);
+}
+CURLSH *ConnectionPool::getShare() const { return share; }
+ConnectionPool &ConnectionPool::instance()
+{
+    static ConnectionPool pool;
+    return pool;
+}
+
+// Lowercase names of the headers a response varies on; "*" when it matches no later request at all
+static std::vector<std::string> varyNames(const Response &response)
+{
+    std::vector<std::string> names;
+    for (std::string name : strUtils::split(response.header("Vary"), ","))
+    {
+        name = strUtils::trim(name);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (!name.empty())
+            names.push_back(name);
+    }
+    return names;
+}
+// Seconds the response stays fresh per Cache-Control max-age less its Age, -1 for no-store
+static int64_t freshness(const Response &response)
+{
+    int64_t maxAge = 0;
+    for (std::string directive : strUtils::split(response.header("Cache-Control"), ","))
+    {
+        directive = strUtils::trim(directive);
+        if (strcasecmp(directive.c_str(), "no-store") == 0)
+            return -1;
+        if (strcasecmp(directive.c_str(), "no-cache") == 0)
+            return 0;
+        if (strncasecmp(directive.c_str(), "max-age=", 8) == 0)
+            maxAge = std::atoll(directive.c_str() + 8);
+    }
+    return std::max<int64_t>(maxAge - std::atoll(response.header("Age").c_str()), 0);
+}
+
+bool HttpCache::ENTRY::fresh() const
+{
+    int64_t now = std::time(nullptr);
+    return now >= storedAt && now - storedAt < maxAge;
+}
+
+HttpCache::HttpCache(std::string directory) : directory(std::move(directory))
+{
+    for (size_t slash = this->directory.find('/', 1); ; slash = this->directory.find('/', slash + 1))
+    {
+        mkdir(this->directory.substr(0, slash).c_str(), 0755);
+        if (slash == std::string::npos)
+            break;
+    }
+}
+
+std::string HttpCache::entryPath(const std::string &url) const
+{
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)std::hash<std::string>{}(url));
+    return directory + "/" + name;
+}
+void HttpCache::save(const std::string &url, const ENTRY &entry)
+{
+    nlohmann::json metadata = {
+        {"url", url},
+        {"status", entry.response.status},
+        {"headers", entry.response.headers},
+        {"vary", entry.vary},
+        {"storedAt", entry.storedAt},
+        {"maxAge", entry.maxAge},
+    };
+    // Written aside and renamed over, a reader never sees half an entry
+    std::string path = entryPath(url);
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file << metadata.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << '\n'
+             << entry.response.body;
+        if (!file.flush())
+        {
+            unlink(temporaryPath.c_str());
+            return;
+        }
+    }
+    rename(temporaryPath.c_str(), path.c_str());
+}
+
+std::unique_ptr<HttpCache::ENTRY> HttpCache::lookup(const std::string &url, const std::unordered_map<std::string, std::string> &requestHeaders)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ifstream file(entryPath(url), std::ios::binary);
+    std::string line;
+    if (!file || !std::getline(file, line))
+        return nullptr;
+    nlohmann::json metadata = nlohmann::json::parse(line, nullptr, false);
+    // Different URLs may share a file name, the entry belongs to the one it records
+    if (metadata.is_discarded() || metadata.value("url", "") != url)
+        return nullptr;
+
+    try
+    {
+        auto entry = std::make_unique<ENTRY>(ENTRY{
+            Response(metadata.at("status").get<int>(), std::string(std::istreambuf_iterator<char>(file), {})),
+            metadata.at("vary").get<std::unordered_map<std::string, std::string>>(),
+            metadata.at("storedAt").get<int64_t>(),
+            metadata.at("maxAge").get<int64_t>(),
+        });
+        entry->response.headers = metadata.at("headers").get<std::unordered_map<std::string, std::string>>();
+        for (const auto &vary : entry->vary)
+            if (findHeader(requestHeaders, vary.first) != vary.second)
+                return nullptr;
+        return entry;
+    }
+    catch (const nlohmann::json::exception &)
+    {
+        return nullptr;
+    }
+}
+void HttpCache::store(const std::string &url, const std::unordered_map<std::string, std::string> &requestHeaders, const Response &response)
+{
+    if (response.status != 200)
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    ENTRY entry{response, {}, std::time(nullptr), freshness(response)};
+    bool validated = !response.header("ETag").empty() || !response.header("Last-Modified").empty();
+    std::vector<std::string> names = varyNames(response);
+    if (entry.maxAge < 0 || (entry.maxAge == 0 && !validated) ||
+        std::find(names.begin(), names.end(), "*") != names.end())
+    {
+        unlink(entryPath(url).c_str());
+        return;
+    }
+    for (const std::string &name : names)
+        entry.vary[name] = findHeader(requestHeaders, name);
+    save(url, entry);
+}
+Response HttpCache::refresh(const std::string &url, ENTRY &entry, const Response &notModified)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &header : notModified.headers)
+    {
+        // The length is the cached body's, not the empty 304's
+        if (strcasecmp(header.first.c_str(), "Content-Length") == 0)
+            continue;
+        for (auto it = entry.response.headers.begin(); it != entry.response.headers.end();)
+            it = strcasecmp(it->first.c_str(), header.first.c_str()) == 0 ? entry.response.headers.erase(it) : std::next(it);
+        entry.response.headers[header.first] = header.second;
+    }
+    entry.storedAt = std::time(nullptr);
+    entry.maxAge = std::max<int64_t>(freshness(entry.response), 0);
+    save(url, entry);
+    return entry.response;
+}
+
+HttpCache &HttpCache::instance()
+{
+    static HttpCache cache;
+    return cache;
+}
 
 size_t Fetch::WriteCallback(void *contents, size_t size, size_t nmemb, std::string *data)
 {
@@ -47,8 +322,74 @@ static int xferinfo(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_of
     const FetchOptions *options = static_cast<const FetchOptions *>(clientp);
     if (options && options->cancelled && options->cancelled->load())
         return 1;
+    if (options && options->progressCallback)
+        options->progressCallback(dlnow, dltotal);
     return 0;
 }
+
+FileSink::FileSink(CURL *curl, int fd, off_t offset, bool partial, bool sync, std::string *fallback)
+    : curl(curl), fd(fd), offset(offset), partial(partial), sync(sync), fallback(fallback), buffer(new char[BUFFER_SIZE]) {}
+bool FileSink::flush()
+{
+    size_t done = 0;
+    while (done < used)
+    {
+        ssize_t written = pwrite(fd, buffer.get() + done, used - done, offset);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            failure = "Failed to write download: " + std::string(strerror(errno));
+            return false;
+        }
+        done += written;
+        offset += written;
+    }
+    used = 0;
+    return true;
+}
+size_t FileSink::WriteCallback(void *contents, size_t size, size_t nmemb, void *userdata)
+{
+    FileSink *sink = static_cast<FileSink *>(userdata);
+    size_t totalSize = size * nmemb;
+    long responseCode = 0;
+    curl_easy_getinfo(sink->curl, CURLINFO_RESPONSE_CODE, &responseCode);
+    if (responseCode < 200 || responseCode >= 300)
+    {
+        sink->fallback->append((char *)contents, totalSize);
+        return totalSize;
+    }
+    // Returning short makes curl fail the transfer with CURLE_WRITE_ERROR
+    if (sink->partial && responseCode != 206)
+    {
+        sink->failure = "Server ignored the Range request";
+        return 0;
+    }
+
+    const char *data = (const char *)contents;
+    size_t remaining = totalSize;
+    while (remaining > 0)
+    {
+        size_t chunk = std::min(remaining, BUFFER_SIZE - sink->used);
+        memcpy(sink->buffer.get() + sink->used, data, chunk);
+        sink->used += chunk;
+        data += chunk;
+        remaining -= chunk;
+        if (sink->used == BUFFER_SIZE && !sink->flush())
+            return 0;
+    }
+    return totalSize;
+}
+void FileSink::finish()
+{
+    if (failure.empty())
+        flush();
+    if (failure.empty() && sync && fsync(fd) != 0)
+        failure = "Failed to write download: " + std::string(strerror(errno));
+    if (!failure.empty())
+        THROW_EXCEPTION(failure);
+}
+
 size_t Fetch::StreamWriteCallback(void *contents, size_t size, size_t nmemb, void *userdata)
 {
     size_t totalSize = size * nmemb;
@@ -81,6 +422,12 @@ size_t Fetch::HeaderCallback(char *buffer, size_t size, size_t nitems, std::unor
     size_t totalSize = size * nitems;
     std::string header(buffer, totalSize);
     header = strUtils::trimEnd(header);
+    // Each status line starts a new response, keep only the headers of the last one a redirect led to
+    if (header.compare(0, 5, "HTTP/") == 0)
+    {
+        headers->clear();
+        return totalSize;
+    }
     size_t colonPos = header.find(':');
     if (colonPos != std::string::npos)
     {
@@ -91,33 +438,32 @@ size_t Fetch::HeaderCallback(char *buffer, size_t size, size_t nitems, std::unor
     return totalSize;
 }
 
-Response Fetch::fetch(const std::string &url, const FetchOptions &options)
+void Fetch::prepare(CURL *curl, const std::string &url, const FetchOptions &options,
+                    std::string *body, std::unordered_map<std::string, std::string> *headers,
+                    FileSink *sink, curl_slist *&requestHeaders)
 {
-    CURL *curl = curl_easy_init();
-    if (!curl)
-        THROW_CURL_ERROR(CURLE_FAILED_INIT);
-
-    long responseCode = 0;
-    std::string responseBody;
-    std::unordered_map<std::string, std::string> responseHeaders;
-
     ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_URL, url.c_str()));
     ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback));
-    ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_HEADERDATA, &responseHeaders));
+    ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_HEADERDATA, headers));
     if (options.timeout > 0)
         ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_TIMEOUT, options.timeout));
     ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, options.followRedirects ? 1L : 0L));
     ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L));
     ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L));
 
-    if (options.cancelled)
+    if (options.cancelled || options.progressCallback)
     {
         ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, xferinfo));
         ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &options));
         ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L));
     }
 
-    if (options.stream && options.streamCallback)
+    if (sink)
+    {
+        ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, FileSink::WriteCallback));
+        ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_WRITEDATA, sink));
+    }
+    else if (options.stream && options.streamCallback)
     {
         ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, StreamWriteCallback));
         ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_WRITEDATA, &options));
@@ -125,39 +471,315 @@ Response Fetch::fetch(const std::string &url, const FetchOptions &options)
     else
     {
         ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback));
-        ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseBody));
+        ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_WRITEDATA, body));
     }
 
+    if (!options.range.empty())
+        ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_RANGE, options.range.c_str()));
+
     if (options.method == "GET")
         ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L));
+    else if (options.method == "HEAD")
+        ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_NOBODY, 1L));
     else if (options.method == "POST")
     {
         ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_POST, 1L));
         if (!options.body.empty())
+        {
+            ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)options.body.size()));
             ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_POSTFIELDS, options.body.c_str()));
+        }
     }
     else
     {
         ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, options.method.c_str()));
         if (!options.body.empty())
+        {
+            ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)options.body.size()));
             ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_POSTFIELDS, options.body.c_str()));
+        }
     }
 
-    struct curl_slist *headers = nullptr;
     for (const auto &header : options.headers)
-        headers = curl_slist_append(headers, std::string(header.first + ": " + header.second).c_str());
-    if (headers)
-        ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers));
+        requestHeaders = curl_slist_append(requestHeaders, std::string(header.first + ": " + header.second).c_str());
+    if (requestHeaders)
+        ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_HTTPHEADER, requestHeaders));
+}
 
-    ASSERT_CURL_OK(curl_easy_perform(curl));
+Response Fetch::fetch(const std::string &url, const FetchOptions &options)
+{
+    // Only whole bodies held in memory are cached
+    if (!options.cache || options.method != "GET" || options.stream || options.sinkFd >= 0 || !options.range.empty())
+        return perform(url, options);
+
+    HttpCache &cache = HttpCache::instance();
+    std::unique_ptr<HttpCache::ENTRY> entry = cache.lookup(url, options.headers);
+    if (entry && entry->fresh())
+        return entry->response;
 
-    ASSERT_CURL_OK(curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode));
+    FetchOptions conditional = options;
+    if (entry)
+    {
+        std::string etag = entry->response.header("ETag");
+        std::string lastModified = entry->response.header("Last-Modified");
+        if (!etag.empty() && findHeader(options.headers, "If-None-Match").empty())
+            conditional.headers["If-None-Match"] = etag;
+        if (!lastModified.empty() && findHeader(options.headers, "If-Modified-Since").empty())
+            conditional.headers["If-Modified-Since"] = lastModified;
+    }
+    Response response = perform(url, conditional);
+    if (response.status == 304 && entry)
+        return cache.refresh(url, *entry, response);
+    cache.store(url, options.headers, response);
+    return response;
+}
+Response Fetch::perform(const std::string &url, const FetchOptions &options)
+{
+    std::string origin = ConnectionPool::origin(url);
+    CURL *curl = ConnectionPool::instance().acquire(origin);
 
-    if (headers)
+    long responseCode = 0;
+    std::string responseBody;
+    std::unordered_map<std::string, std::string> responseHeaders;
+    struct curl_slist *headers = nullptr;
+
+    std::unique_ptr<FileSink> sink;
+    if (options.sinkFd >= 0)
+        sink = std::make_unique<FileSink>(curl, options.sinkFd, options.sinkOffset, !options.range.empty(), options.sinkSync, &responseBody);
+
+    try
+    {
+        prepare(curl, url, options, &responseBody, &responseHeaders, sink.get(), headers);
+        CURLcode result = curl_easy_perform(curl);
+        // A failed write is the more useful error than the CURLE_WRITE_ERROR it caused
+        if (sink)
+            sink->finish();
+        ASSERT_CURL_OK(result);
+        ASSERT_CURL_OK(curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode));
+    }
+    catch (...)
+    {
+        // The connection may be half way through a response, don't hand it to the next request
         curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+        ConnectionPool::instance().release(origin, curl, false);
+        throw;
+    }
+
+    curl_slist_free_all(headers);
+    // A cancelled transfer leaves its connection mid-response
+    bool cancelled = options.cancelled && options.cancelled->load();
+    ConnectionPool::instance().release(origin, curl, !cancelled);
 
     Response response(responseCode, responseBody);
     response.headers = responseHeaders;
     return response;
 }
+void Fetch::fetchAsync(const std::string &url, FetchOptions options, FetchCallback callback)
+{
+    FetchEngine::instance().submit(url, std::move(options), std::move(callback));
+}
+
+FetchEngine::FetchEngine() : share(ConnectionPool::instance().getShare()), multi(curl_multi_init())
+{
+    if (!multi)
+        THROW_CURL_ERROR(CURLE_FAILED_INIT);
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, MAX_CONNECTIONS);
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, MAX_HOST_CONNECTIONS);
+    curl_multi_setopt(multi, CURLMOPT_MAXCONNECTS, MAX_CONNECTIONS);
+    ioThread = std::thread(&FetchEngine::ioLoop, this);
+    callbackThread = std::thread(&FetchEngine::callbackLoop, this);
+}
+FetchEngine::~FetchEngine()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    curl_multi_wakeup(multi);
+    ioThread.join();
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        tasksStopping = true;
+        tasks.clear();
+    }
+    tasksCondition.notify_all();
+    callbackThread.join();
+
+    // Unfinished transfers are dropped without calling back, their owners are being destroyed too
+    for (auto &pair : running)
+    {
+        curl_multi_remove_handle(multi, pair.first);
+        curl_slist_free_all(pair.second->requestHeaders);
+        curl_easy_cleanup(pair.first);
+    }
+    for (auto &transfer : incoming)
+    {
+        curl_slist_free_all(transfer->requestHeaders);
+        curl_easy_cleanup(transfer->curl);
+    }
+    curl_multi_cleanup(multi);
+}
+
+void FetchEngine::ioLoop()
+{
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping)
+                return;
+            for (auto &transfer : incoming)
+            {
+                CURL *curl = transfer->curl;
+                CURLMcode code = curl_multi_add_handle(multi, curl);
+                if (code != CURLM_OK)
+                {
+                    auto callback = transfer->callback;
+                    std::string error = "CURL multi error " + std::to_string(code) + ": " + curl_multi_strerror(code);
+                    curl_slist_free_all(transfer->requestHeaders);
+                    curl_easy_cleanup(curl);
+                    post([callback, error]
+                         { callback(Response(0, ""), error); });
+                    continue;
+                }
+                running[curl] = std::move(transfer);
+            }
+            incoming.clear();
+        }
+
+        int stillRunning = 0;
+        curl_multi_perform(multi, &stillRunning);
+        CURLMsg *message;
+        int queued = 0;
+        while ((message = curl_multi_info_read(multi, &queued)))
+            if (message->msg == CURLMSG_DONE)
+                finish(message->easy_handle, message->data.result);
+
+        curl_multi_poll(multi, nullptr, 0, POLL_MILLIS, nullptr);
+    }
+}
+void FetchEngine::finish(CURL *curl, CURLcode result)
+{
+    auto it = running.find(curl);
+    if (it == running.end())
+        return;
+    std::unique_ptr<TRANSFER> transfer = std::move(it->second);
+    running.erase(it);
+
+    long responseCode = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
+    curl_multi_remove_handle(multi, curl);
+    curl_slist_free_all(transfer->requestHeaders);
+    curl_easy_cleanup(curl);
+
+    // A cancelled transfer completes with whatever arrived, however the callbacks stopped it
+    bool cancelled = transfer->options.cancelled && transfer->options.cancelled->load();
+    std::string error;
+    if (!cancelled && result != CURLE_OK && result != CURLE_ABORTED_BY_CALLBACK)
+        error = CurlError(__FILE__, __LINE__, result).what();
+    auto response = std::make_shared<Response>(responseCode, std::move(transfer->body));
+    response->headers = std::move(transfer->headers);
+    FetchCallback callback = std::move(transfer->callback);
+    std::shared_ptr<FileSink> sink = std::move(transfer->sink);
+    // The final flush and fsync can take a while on flash, keep them off the I/O thread
+    post([callback, response, error, sink]() mutable
+         {
+             try
+             {
+                 if (sink)
+                     sink->finish();
+             }
+             catch (const std::exception &e)
+             {
+                 error = e.what();
+             }
+             callback(std::move(*response), error); });
+}
+
+void FetchEngine::callbackLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex);
+            tasksCondition.wait(lock, [this]
+                                { return tasksStopping || !tasks.empty(); });
+            if (tasksStopping)
+                return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        try
+        {
+            task();
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Fetch callback error: " << e.what() << std::endl;
+        }
+    }
+}
+void FetchEngine::post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        tasks.push_back(std::move(task));
+    }
+    tasksCondition.notify_one();
+}
+
+void FetchEngine::submit(const std::string &url, FetchOptions options, FetchCallback callback)
+{
+    CURL *curl = curl_easy_init();
+    if (!curl)
+        THROW_CURL_ERROR(CURLE_FAILED_INIT);
+
+    auto transfer = std::make_unique<TRANSFER>(TRANSFER{curl, std::move(options), "", {}, nullptr, nullptr, std::move(callback)});
+    if (transfer->options.sinkFd >= 0)
+        transfer->sink = std::make_unique<FileSink>(curl, transfer->options.sinkFd, transfer->options.sinkOffset,
+                                                    !transfer->options.range.empty(), transfer->options.sinkSync, &transfer->body);
+    if (transfer->options.stream && transfer->options.streamCallback)
+    {
+        // Parsed on the I/O thread, delivered on the callback thread
+        StreamCallback streamCallback = std::move(transfer->options.streamCallback);
+        transfer->options.streamCallback = [this, streamCallback](const std::string &chunk)
+        {
+            post([streamCallback, chunk]
+                 { streamCallback(chunk); });
+        };
+    }
+
+    try
+    {
+        Fetch::prepare(curl, url, transfer->options, &transfer->body, &transfer->headers, transfer->sink.get(), transfer->requestHeaders);
+        ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_SHARE, share));
+        if (transfer->options.multiplex)
+        {
+            ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS));
+            // Wait for a connection that can multiplex instead of opening another one
+            ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L));
+        }
+        else
+            // HTTP/1.1 connections carry one transfer at a time, so this one gets a connection to itself
+            ASSERT_CURL_OK(curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_1_1));
+    }
+    catch (...)
+    {
+        curl_slist_free_all(transfer->requestHeaders);
+        curl_easy_cleanup(curl);
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        incoming.push_back(std::move(transfer));
+    }
+    curl_multi_wakeup(multi);
+}
+FetchEngine &FetchEngine::instance()
+{
+    static FetchEngine engine;
+    return engine;
+}
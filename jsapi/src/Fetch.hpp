@@ -21,6 +21,14 @@
 #include <unordered_map>
 #include <functional>
 #include <atomic>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <deque>
+#include <condition_variable>
+#include <sys/types.h>
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
 #include <Exceptions/CurlError.hpp>
@@ -34,6 +42,11 @@
     } while (false)
 
 using StreamCallback = std::function<void(const std::string &chunk)>;
+// Bytes received so far and the expected total, 0 while unknown
+using ProgressCallback = std::function<void(int64_t received, int64_t total)>;
+class Response;
+// error is empty when the transfer completed, whatever its HTTP status
+using FetchCallback = std::function<void(Response response, const std::string &error)>;
 
 class Response
 {
@@ -47,6 +60,8 @@ public:
     nlohmann::json json();
     std::string text();
     bool isOk();
+    // Value of the header called name in any letter case, empty when absent
+    std::string header(const std::string &name) const;
 };
 
 class FetchOptions
@@ -60,6 +75,19 @@ public:
     size_t timeout;
     bool followRedirects = true;
     std::shared_ptr<std::atomic<bool>> cancelled;
+    // Streams a 2xx body to this descriptor instead of Response::body, fsynced before the fetch completes
+    // unless sinkSync is false, which leaves syncing to the caller
+    int sinkFd = -1;
+    off_t sinkOffset = 0; // where in sinkFd the body starts
+    bool sinkSync = true;
+    // "first-last" bytes to request; the server must then answer 206, a whole 200 body fails a sink
+    std::string range;
+    ProgressCallback progressCallback;
+    // Fetch::fetch of a GET: answer from, revalidate against and fill HttpCache
+    bool cache = false;
+    // Fetch::fetchAsync: share an HTTP/2 connection with other transfers to the host. False gives the transfer
+    // a connection of its own, for parallel downloads that each want their own TCP stream.
+    bool multiplex = true;
 
     FetchOptions(std::string method = "GET",
                  std::unordered_map<std::string, std::string> headers = {},
@@ -68,9 +96,167 @@ public:
                  StreamCallback streamCallback = nullptr,
                  size_t timeout = 10,
                  std::shared_ptr<std::atomic<bool>> cancelled = nullptr)
-        : method(method), headers(headers), body(body),
-          stream(stream), streamCallback(streamCallback), timeout(timeout),
-          cancelled(cancelled) {}
+        : method(std::move(method)), headers(std::move(headers)), body(std::move(body)),
+          stream(stream), streamCallback(std::move(streamCallback)), timeout(timeout),
+          cancelled(std::move(cancelled)) {}
+};
+
+// Writes a response body to a file descriptor through a fixed buffer, so memory stays constant whatever
+// the size. Bodies of other than 2xx responses, error pages, are kept in fallback instead.
+// A partial sink only accepts 206: a server ignoring the Range would otherwise write the whole file at offset.
+class FileSink
+{
+private:
+    CURL *curl;
+    int fd;
+    off_t offset;
+    bool partial;
+    bool sync;
+    std::string *fallback;
+    std::unique_ptr<char[]> buffer;
+    size_t used = 0;
+    std::string failure; // why the transfer was stopped, empty while writing fine
+
+    bool flush();
+
+public:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    FileSink(CURL *curl, int fd, off_t offset, bool partial, bool sync, std::string *fallback);
+    static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userdata);
+    // Writes out what is still buffered and fsyncs if sync; throws if anything could not be written
+    void finish();
+};
+
+// Easy handles kept per origin together with their open connections, all sharing one DNS cache and
+// TLS session cache, so later requests to the same API host skip the lookup and both handshakes.
+// Connections stay with their handle: libcurl does not support sharing them between threads.
+class ConnectionPool
+{
+private:
+    struct IdleHandle
+    {
+        CURL *curl;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::vector<IdleHandle>> idle;
+    size_t idleCount = 0;
+    CURLSH *share;
+    std::mutex shareLocks[CURL_LOCK_DATA_LAST];
+
+    static void lock(CURL *curl, curl_lock_data data, curl_lock_access access, void *userptr);
+    static void unlock(CURL *curl, curl_lock_data data, void *userptr);
+    void evictExpired(std::chrono::steady_clock::time_point now);
+
+public:
+    static constexpr size_t MAX_IDLE_PER_HOST = 4;
+    static constexpr size_t MAX_IDLE = 16;
+    static constexpr long MAX_CONNECTIONS_PER_HANDLE = 2;
+    static constexpr std::chrono::seconds IDLE_TIMEOUT{60};
+
+    ConnectionPool();
+    ~ConnectionPool();
+
+    // scheme://host[:port] of url, the key handles are pooled under
+    static std::string origin(const std::string &url);
+    // A reset handle already attached to the share
+    CURL *acquire(const std::string &origin);
+    // Pools curl for the next request to origin, or cleans it up when reusable is false or the pool is full
+    void release(const std::string &origin, CURL *curl, bool reusable);
+    CURLSH *getShare() const;
+
+    static ConnectionPool &instance();
+};
+
+// Runs every Fetch::fetchAsync transfer on one I/O thread through a curl_multi handle, so requests to the same
+// host share connections (multiplexed over HTTP/2 where the server offers it). Stream and completion callbacks
+// are queued to a separate callback thread, in order, so slow callbacks never stall the transfers.
+class FetchEngine
+{
+private:
+    struct TRANSFER
+    {
+        CURL *curl;
+        FetchOptions options;
+        std::string body;
+        std::unordered_map<std::string, std::string> headers;
+        curl_slist *requestHeaders = nullptr;
+        std::unique_ptr<FileSink> sink;
+        FetchCallback callback;
+    };
+
+    CURLSH *share; // ConnectionPool's, looked up first so the pool outlives the engine
+    CURLM *multi;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<TRANSFER>> incoming;
+    std::unordered_map<CURL *, std::unique_ptr<TRANSFER>> running; // I/O thread only
+    bool stopping = false;
+    std::thread ioThread;
+
+    std::deque<std::function<void()>> tasks;
+    std::mutex tasksMutex;
+    std::condition_variable tasksCondition;
+    bool tasksStopping = false;
+    std::thread callbackThread;
+
+    void ioLoop();
+    void callbackLoop();
+    void post(std::function<void()> task);
+    void finish(CURL *curl, CURLcode result);
+
+public:
+    static constexpr long MAX_CONNECTIONS = 16;
+    static constexpr long MAX_HOST_CONNECTIONS = 4;
+    // Upper bound on how long a cancelled transfer takes to notice
+    static constexpr int POLL_MILLIS = 1000;
+
+    FetchEngine();
+    ~FetchEngine();
+
+    void submit(const std::string &url, FetchOptions options, FetchCallback callback);
+
+    static FetchEngine &instance();
+};
+
+// GET responses kept on disk, one entry per URL, each file the metadata as a JSON line followed by the body.
+// An entry is served without a request while Cache-Control max-age says it is fresh, and otherwise revalidated
+// with If-None-Match / If-Modified-Since, a 304 then costing no body. It only answers requests that agree with
+// the one that stored it on every header the response named in Vary.
+class HttpCache
+{
+public:
+    struct ENTRY
+    {
+        Response response;
+        std::unordered_map<std::string, std::string> vary; // lowercase header name -> request value
+        int64_t storedAt; // unix seconds
+        int64_t maxAge;
+
+        bool fresh() const;
+    };
+
+private:
+    std::string directory;
+    std::mutex mutex;
+
+    std::string entryPath(const std::string &url) const;
+    void save(const std::string &url, const ENTRY &entry);
+
+public:
+    static constexpr const char *DIRECTORY = "/userdisk/cache/http";
+
+    HttpCache(std::string directory = DIRECTORY);
+
+    // The entry stored for url when requestHeaders match its Vary headers, nullptr otherwise
+    std::unique_ptr<ENTRY> lookup(const std::string &url, const std::unordered_map<std::string, std::string> &requestHeaders);
+    // Keeps a 200 response that has a validator or a max-age, and drops the entry of one marked no-store
+    void store(const std::string &url, const std::unordered_map<std::string, std::string> &requestHeaders, const Response &response);
+    // Takes the headers of a 304 into entry, restarts its freshness and returns the cached response
+    Response refresh(const std::string &url, ENTRY &entry, const Response &notModified);
+
+    static HttpCache &instance();
 };
 
 class Fetch
@@ -79,7 +265,16 @@ private:
     static size_t WriteCallback(void *contents, size_t size, size_t nmemb, std::string *data);
     static size_t StreamWriteCallback(void *contents, size_t size, size_t nmemb, void *userdata);
     static size_t HeaderCallback(char *buffer, size_t size, size_t nitems, std::unordered_map<std::string, std::string> *headers);
+    // Sets every option of the request; requestHeaders receives the header list to free once the transfer is done
+    static void prepare(CURL *curl, const std::string &url, const FetchOptions &options,
+                        std::string *body, std::unordered_map<std::string, std::string> *headers,
+                        FileSink *sink, curl_slist *&requestHeaders);
+    static Response perform(const std::string &url, const FetchOptions &options);
+
+    friend class FetchEngine;
 
 public:
     static Response fetch(const std::string &url, const FetchOptions &options = FetchOptions{});
+    // Returns at once, options.cache is not used; callback runs on the FetchEngine callback thread, as does options.streamCallback
+    static void fetchAsync(const std::string &url, FetchOptions options, FetchCallback callback);
 };
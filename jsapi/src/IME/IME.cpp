@@ -18,17 +18,31 @@
 #include "IME.hpp"
 #include "strUtils.hpp"
 #include <algorithm>
+#include <iostream>
 #include <sstream>
 #include <string.h>
 #include <stdlib.h>
 #include "rawdict_data.hpp"
 
-IME::IME() : database("/userdisk/database/langningchen-ime.db")
+IME::IME(const std::string &filePath, const DatabaseOptions &options) : database(filePath, options)
 {
+    database.migrate(1, [this]
+                     {
+                         // hanZi used to be UNIQUE on its own, which rejected a word under a second reading
+                         if (database.query("SELECT name FROM sqlite_master WHERE type='table' AND name=?")
+                                 .bind("ime_dict")
+                                 .execute()
+                                 .empty())
+                             return;
+                         database.query("CREATE TABLE ime_dict_v1 (pinyin TEXT NOT NULL, hanZi TEXT NOT NULL, freq REAL NOT NULL)").execute();
+                         database.query("INSERT INTO ime_dict_v1 SELECT pinyin, hanZi, MAX(freq) FROM ime_dict GROUP BY pinyin, hanZi").execute();
+                         database.query("DROP TABLE ime_dict").execute();
+                         database.query("ALTER TABLE ime_dict_v1 RENAME TO ime_dict").execute(); });
     database.table("ime_dict")
         .column("pinyin", TABLE::TEXT, TABLE::NOT_NULL)
-        .column("hanZi", TABLE::TEXT, TABLE::NOT_NULL | TABLE::UNIQUE)
+        .column("hanZi", TABLE::TEXT, TABLE::NOT_NULL)
         .column("freq", TABLE::REAL, TABLE::NOT_NULL)
+        .index({"pinyin", "hanZi"}, TABLE::UNIQUE)
         .execute();
 
     pinyinDict.reserve(100000);
@@ -162,14 +176,14 @@ void IME::initialize()
             }
     }
 
-    auto rows = database.select("ime_dict").select("pinyin").select("hanZi").select("freq").execute();
+    auto rows = database.select("ime_dict").select("pinyin").select("hanZi").select("freq").cursor();
     for (const auto &row : rows)
     {
-        Pinyin pinyin = strUtils::split(row.at("pinyin"), " ");
+        Pinyin pinyin = strUtils::split(std::string(row.getText(0)), " ");
         for (const auto &pinyinUnit : pinyin)
             pinyinUnits.insert(pinyinUnit);
-        std::string hanZi = row.at("hanZi");
-        double freq = std::stod(row.at("freq"));
+        std::string hanZi(row.getText(1));
+        double freq = row.getDouble(2);
         insert(pinyin, hanZi, freq);
     }
 
@@ -204,25 +218,20 @@ void IME::updateWordFrequency(const Pinyin &pinyin, const std::string &hanZi)
     double newFreq = freq ? freq + 100 : 500;
     insert(pinyin, hanZi, newFreq);
 
-    std::string pinyinStr = strUtils::join(pinyin, " ");
-    auto data = database.select("ime_dict").where("pinyin", pinyinStr).where("hanZi", hanZi).execute();
-    if (data.empty())
-    {
-        database.insert("ime_dict")
-            .value("pinyin", pinyinStr)
-            .value("hanZi", hanZi)
-            .value("freq", newFreq)
-            .execute();
-    }
-    else
-    {
-        database.update("ime_dict")
-            .set("freq", std::to_string(newFreq))
-            .where("pinyin", pinyinStr)
-            .where("hanZi", hanZi)
-            .execute();
-    }
+    // Lookups only read the in-memory dictionary, so persisting can happen on the writer thread
+    database.write([this, pinyinStr = strUtils::join(pinyin, " "), hanZi, newFreq]()
+                   { database.upsert("ime_dict")
+                         .value("pinyin", pinyinStr)
+                         .value("hanZi", hanZi)
+                         .value("freq", newFreq)
+                         .conflict("pinyin")
+                         .conflict("hanZi")
+                         .update("freq", "\"freq\" + ?", {100.0})
+                         .execute(); },
+                   [](const std::string &error)
+                   { std::cerr << "Saving word frequency failed: " << error << std::endl; });
 }
+PROFILER *IME::getDatabaseProfiler() { return database.enableProfiler(); }
 Pinyin IME::splitPinyin(const std::string &rawPinyin)
 {
     Pinyin pinyin;
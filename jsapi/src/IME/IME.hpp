@@ -54,9 +54,12 @@ private:
 public:
     bool initialized = false;
 
-    IME();
+    IME(const std::string &filePath = "/userdisk/database/langningchen-ime.db",
+        const DatabaseOptions &options = DatabaseOptions::userDictionary());
     void initialize();
     std::vector<Candidate> getCandidates(const std::string &rawPinyin);
     void updateWordFrequency(const Pinyin &pinyin, const std::string &hanZi);
     Pinyin splitPinyin(const std::string &rawPinyin);
+    // Statement timings, recorded from the first call on
+    PROFILER *getDatabaseProfiler();
 };
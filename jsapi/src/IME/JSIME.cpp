@@ -106,6 +106,24 @@ void JSIME::splitPinyin(JQFunctionInfo &info)
     }
 }
 
+void JSIME::getDatabaseStats(JQFunctionInfo &info)
+{
+    try
+    {
+        ASSERT(IMEObject != nullptr);
+        ASSERT(info.Length() <= 1);
+        PROFILER *profiler = IMEObject->getDatabaseProfiler();
+        ASSERT(profiler != nullptr);
+        info.GetReturnValue().Set(JSProfiler::toBson(*profiler));
+        if (info.Length() == 1 && JQBool(info.GetContext(), info[0]).getBool())
+            profiler->reset();
+    }
+    catch (const std::exception &e)
+    {
+        info.GetReturnValue().ThrowInternalError(e.what());
+    }
+}
+
 JSValue createIME(JQModuleEnv *env)
 {
     JQFunctionTemplateRef tpl = JQFunctionTemplate::New(env, "IME");
@@ -115,6 +133,7 @@ JSValue createIME(JQModuleEnv *env)
     tpl->SetProtoMethod("getCandidates", &JSIME::getCandidates);
     tpl->SetProtoMethod("updateWordFrequency", &JSIME::updateWordFrequency);
     tpl->SetProtoMethod("splitPinyin", &JSIME::splitPinyin);
+    tpl->SetProtoMethod("getDatabaseStats", &JSIME::getDatabaseStats);
 
     tpl->SetProtoMethodPromise("initialize", &JSIME::initialize);
 
@@ -20,6 +20,7 @@
 #include <jqutil_v2/jqutil.h>
 #include <memory>
 #include "IME.hpp"
+#include "Database/JSProfiler.hpp"
 
 using namespace JQUTIL_NS;
 
@@ -36,6 +37,7 @@ public:
     void getCandidates(JQFunctionInfo &info);
     void updateWordFrequency(JQFunctionInfo &info);
     void splitPinyin(JQFunctionInfo &info);
+    void getDatabaseStats(JQFunctionInfo &info);
 };
 
 extern JSValue createIME(JQModuleEnv *env);
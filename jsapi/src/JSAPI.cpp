@@ -5,6 +5,7 @@
 #include "ScanInput/JSScanInput.hpp"
 #include "Shell/JSShell.hpp"
 #include "Update/JSUpdate.hpp"
+#include "Database/JSDatabase.hpp"
 
 using namespace JQUTIL_NS;
 
@@ -13,7 +14,8 @@ static std::vector<std::string> exportList = {
     "IME",
     "ScanInput",
     "Shell",
-    "Update"
+    "Update",
+    "Database"
 };
 
 static int module_init(JSContext *ctx, JSModuleDef *m)
@@ -25,6 +27,7 @@ static int module_init(JSContext *ctx, JSModuleDef *m)
     env->setModuleExport("ScanInput", createScanInput(env.get()));
     env->setModuleExport("Shell", createShell(env.get()));
     env->setModuleExport("Update", createUpdate(env.get()));
+    env->setModuleExport("Database", createDatabase(env.get()));
 
     env->setModuleExportDone(JS_UNDEFINED, exportList);
     return 0;
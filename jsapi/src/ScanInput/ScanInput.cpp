@@ -18,7 +18,7 @@
 #include "ScanInput.hpp"
 #include <unistd.h>
 
-ScanInput::ScanInput() : database("/userdisk/database/history.db") {}
+ScanInput::ScanInput() : database("/userdisk/database/history.db", DatabaseOptions::externalReadOnly()) {}
 
 void ScanInput::initialize(ScanInputCallback callback)
 {
@@ -29,24 +29,32 @@ void ScanInput::initialize(ScanInputCallback callback)
         [this, callback]()
         {
             std::string lastString = "";
+            int64_t dataVersion = -1;
             while (this->initialized)
             {
-                auto historyData = database.select("table_history")
-                                       .select("word")
-                                       .order("timestamp", false)
-                                       .limit(1)
-                                       .execute();
-                if (historyData.size())
+                // history.db is written by another process, so no update hook fires here; data_version is a
+                // cheap check that it committed something since the last round
+                int64_t currentVersion = database.getDataVersion();
+                if (currentVersion != dataVersion)
                 {
-                    std::string currentString = historyData[0]["word"];
-                    if (currentString != lastString)
+                    dataVersion = currentVersion;
+                    auto historyData = database.select("table_history")
+                                           .select("word")
+                                           .order("timestamp", false)
+                                           .limit(1)
+                                           .execute();
+                    if (historyData.size())
                     {
-                        if (lastString != "")
+                        std::string currentString = historyData[0].getString(0);
+                        if (currentString != lastString)
                         {
-                            system("miniapp_cli start 8001749644971193 softKeyboard");
-                            callback(currentString);
+                            if (lastString != "")
+                            {
+                                system("miniapp_cli start 8001749644971193 softKeyboard");
+                                callback(currentString);
+                            }
+                            lastString = currentString;
                         }
-                        lastString = currentString;
                     }
                 }
                 sleep(1);
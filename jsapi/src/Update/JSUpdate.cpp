@@ -1,5 +1,6 @@
 #include "JSUpdate.hpp"
 #include "Fetch.hpp"
+#include "SegmentedDownload.hpp"
 #include "Exceptions/AssertFailed.hpp"
 #include "Exceptions/NetworkError.hpp"
 #include "strUtils.hpp"
@@ -8,6 +9,7 @@
 #include <regex>
 #include <fstream>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <dirent.h>
@@ -48,36 +50,78 @@ bool JSUpdate::versionGreater(const std::string& a, const std::string& b) {
     return false;
 }
 
-bool JSUpdate::downloadFile(const std::string& url, const std::string& savePath) {
-    try {
+void JSUpdate::downloadFile(const std::string& url, const std::string& savePath) {
+    // 确保目录存在
+    std::string dir = savePath.substr(0, savePath.find_last_of('/'));
+    std::string dirCmd = "mkdir -p \"" + dir + "\"";
+    system(dirCmd.c_str());
+    
+    // 先写入临时文件，下载完整后再改名，避免留下不完整的文件
+    std::string partPath = savePath + ".part";
+    
+    // 每收到 PROGRESS_STEP 字节通知一次进度，避免事件过多
+    const int64_t PROGRESS_STEP = 256 * 1024;
+    int64_t lastReported = -1;
+    ProgressCallback progress = [this, &lastReported, PROGRESS_STEP](int64_t received, int64_t total) {
+        bool finished = total > 0 && received == total;
+        if (received == lastReported || (received - lastReported < PROGRESS_STEP && !finished)) {
+            return;
+        }
+        lastReported = received;
+        publish("update_progress", Bson::object{
+            {"received", static_cast<double>(received)},
+            {"total", static_cast<double>(total)}
+        });
+    };
+    
+    // 服务器支持 Range 时分段并行下载，失败后保留 .part 与进度文件，下次从断点继续
+    SegmentedDownload segmented(url, partPath);
+    segmented.header("User-Agent", "miniapp-updater/1.0").onProgress(progress);
+    if (!segmented.run()) {
+        int fd = open(partPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            THROW_EXCEPTION("Failed to create file: " + partPath);
+        }
+        
         FetchOptions options;
         options.timeout = 300;
         options.headers["User-Agent"] = "miniapp-updater/1.0";
+        options.sinkFd = fd;
+        options.progressCallback = progress;
         
-        Response response = Fetch::fetch(url, options);
-        
-        if (response.isOk()) {
-            // 确保目录存在
-            std::string dir = savePath.substr(0, savePath.find_last_of('/'));
-            std::string dirCmd = "mkdir -p \"" + dir + "\"";
-            system(dirCmd.c_str());
-            
-            // 写入文件
-            std::ofstream file(savePath, std::ios::binary);
-            if (file) {
-                file.write(response.body.c_str(), response.body.size());
-                file.close();
-                
-                // 设置文件权限
-                chmod(savePath.c_str(), 0644);
-                return true;
+        try {
+            Response response = Fetch::fetch(url, options);
+            if (!response.isOk()) {
+                THROW_NETWORK_ERROR(response.status);
             }
+        } catch (...) {
+            close(fd);
+            unlink(partPath.c_str());
+            throw;
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Download error: " << e.what() << std::endl;
+        close(fd);
     }
     
-    return false;
+    if (rename(partPath.c_str(), savePath.c_str()) != 0) {
+        unlink(partPath.c_str());
+        THROW_EXCEPTION("Failed to move download to " + savePath);
+    }
+    
+    // 设置文件权限
+    chmod(savePath.c_str(), 0644);
+}
+
+Response JSUpdate::fetchLatestRelease() {
+    std::string url = "https://api.github.com/repos/" + owner + "/" + repo + "/releases/latest";
+    
+    FetchOptions options;
+    options.headers["User-Agent"] = "miniapp-updater/1.0";
+    options.headers["Accept"] = "application/vnd.github.v3+json";
+    options.timeout = 30;
+    // 缓存有效期内不发请求，过期后带 ETag 重新验证，未变化时服务器只返回 304
+    options.cache = true;
+    
+    return Fetch::fetch(url, options);
 }
 
 std::string JSUpdate::execShell(const std::string& cmd) {
@@ -182,15 +226,7 @@ void JSUpdate::check(JQAsyncInfo& info) {
     try {
         std::lock_guard<std::mutex> lock(configMutex);
         
-        // 构建GitHub API URL
-        std::string url = "https://api.github.com/repos/" + owner + "/" + repo + "/releases/latest";
-        
-        FetchOptions options;
-        options.headers["User-Agent"] = "miniapp-updater/1.0";
-        options.headers["Accept"] = "application/vnd.github.v3+json";
-        options.timeout = 30;
-        
-        Response response = Fetch::fetch(url, options);
+        Response response = fetchLatestRelease();
         
         if (!response.isOk()) {
             info.post(Bson::object{
@@ -285,14 +321,8 @@ void JSUpdate::download(JQAsyncInfo& info) {
     try {
         std::lock_guard<std::mutex> lock(configMutex);
         
-        // 先检查更新以获取下载URL
-        std::string checkUrl = "https://api.github.com/repos/" + owner + "/" + repo + "/releases/latest";
-        
-        FetchOptions checkOptions;
-        checkOptions.headers["User-Agent"] = "miniapp-updater/1.0";
-        checkOptions.timeout = 30;
-        
-        Response checkResponse = Fetch::fetch(checkUrl, checkOptions);
+        // 先检查更新以获取下载URL，紧接在 check 之后时直接由缓存返回
+        Response checkResponse = fetchLatestRelease();
         
         if (!checkResponse.isOk()) {
             info.post(Bson::object{
@@ -336,41 +366,17 @@ void JSUpdate::download(JQAsyncInfo& info) {
         // 构建保存路径
         std::string savePath = downloadPath + "/" + assetName;
         
-        // 开始下载
-        FetchOptions downloadOptions;
-        downloadOptions.headers["User-Agent"] = "miniapp-updater/1.0";
-        downloadOptions.timeout = 300; // 5分钟超时
-        
-        Response downloadResponse = Fetch::fetch(downloadUrl, downloadOptions);
-        
-        if (!downloadResponse.isOk()) {
-            info.post(Bson::object{
-                {"success", false},
-                {"error", "Download failed: HTTP " + std::to_string(downloadResponse.status)}
-            });
-            return;
-        }
-        
-        // 确保目录存在
-        std::string dirCmd = "mkdir -p \"" + downloadPath + "\"";
-        system(dirCmd.c_str());
-        
-        // 保存文件
-        std::ofstream file(savePath, std::ios::binary);
-        if (!file) {
+        // 开始下载，数据直接写入文件
+        try {
+            downloadFile(downloadUrl, savePath);
+        } catch (const std::exception& e) {
             info.post(Bson::object{
                 {"success", false},
-                {"error", "Failed to create file: " + savePath}
+                {"error", "Download failed: " + std::string(e.what())}
             });
             return;
         }
         
-        file.write(downloadResponse.body.c_str(), downloadResponse.body.size());
-        file.close();
-        
-        // 设置文件权限
-        chmod(savePath.c_str(), 0644);
-        
         // 获取文件大小
         struct stat fileStat;
         int fileSize = 0;
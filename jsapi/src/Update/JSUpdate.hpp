@@ -1,6 +1,7 @@
 #pragma once
 
 #include <jqutil_v2/jqutil.h>
+#include "Fetch.hpp"
 #include <string>
 #include <mutex>
 #include <unordered_map>
@@ -20,7 +21,10 @@ private:
     mutable std::mutex configMutex;
     
     bool versionGreater(const std::string& a, const std::string& b);
-    bool downloadFile(const std::string& url, const std::string& savePath);
+    // 流式写入 savePath，内存占用与文件大小无关；失败时抛出异常
+    void downloadFile(const std::string& url, const std::string& savePath);
+    // GitHub releases/latest，经 HttpCache 缓存；调用时须持有 configMutex
+    Response fetchLatestRelease();
     std::string execShell(const std::string& cmd);
 
 public:
@@ -0,0 +1,238 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "SegmentedDownload.hpp"
+#include "Exceptions/Exception.hpp"
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <strings.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+SegmentedDownload::SegmentedDownload(std::string url, std::string path, size_t connections)
+    : url(std::move(url)), path(path), progressPath(path + ".progress"), connections(std::max<size_t>(connections, 1)) {}
+SegmentedDownload::~SegmentedDownload()
+{
+    if (fd >= 0)
+        close(fd);
+}
+SegmentedDownload &SegmentedDownload::header(std::string name, std::string value)
+{
+    headers[name] = value;
+    return *this;
+}
+SegmentedDownload &SegmentedDownload::onProgress(ProgressCallback callback)
+{
+    progressCallback = std::move(callback);
+    return *this;
+}
+
+bool SegmentedDownload::loadProgress()
+{
+    std::ifstream file(progressPath);
+    if (!file)
+        return false;
+    nlohmann::json progress = nlohmann::json::parse(file, nullptr, false);
+    // Without a validator there is no telling whether the server still has the same file
+    if (progress.is_discarded() || validator.empty() ||
+        progress.value("url", "") != url ||
+        progress.value("size", (int64_t)-1) != size ||
+        progress.value("validator", "") != validator ||
+        progress.value("pieceSize", (int64_t)-1) != PIECE_SIZE ||
+        !progress["done"].is_array())
+        return false;
+    struct stat fileStat;
+    if (stat(path.c_str(), &fileStat) != 0 || fileStat.st_size != size)
+        return false;
+
+    for (const auto &piece : progress["done"])
+        if (piece.is_number_unsigned() && piece.get<size_t>() < done.size())
+            done[piece.get<size_t>()] = true;
+    return true;
+}
+void SegmentedDownload::saveProgress()
+{
+    nlohmann::json finished = nlohmann::json::array();
+    for (size_t piece = 0; piece < done.size(); piece++)
+        if (done[piece])
+            finished.push_back(piece);
+    std::string data = nlohmann::json{
+        {"url", url},
+        {"size", size},
+        {"validator", validator},
+        {"pieceSize", PIECE_SIZE},
+        {"done", finished},
+    }.dump();
+
+    // Written aside and renamed over, so a crash leaves either the old or the new progress
+    std::string temporaryPath = progressPath + ".tmp";
+    int progressFd = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (progressFd < 0)
+        THROW_EXCEPTION("Failed to save download progress: " + std::string(strerror(errno)));
+    size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t result = write(progressFd, data.data() + written, data.size() - written);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result < 0)
+            break;
+        written += result;
+    }
+    bool saved = written == data.size() && fsync(progressFd) == 0;
+    close(progressFd);
+    if (!saved || rename(temporaryPath.c_str(), progressPath.c_str()) != 0)
+        THROW_EXCEPTION("Failed to save download progress: " + std::string(strerror(errno)));
+}
+
+void SegmentedDownload::startPieces()
+{
+    while (failure.empty() && inFlight < connections && !pending.empty())
+    {
+        size_t piece = pending.front();
+        pending.pop_front();
+        int64_t first = piece * PIECE_SIZE;
+        int64_t last = std::min(first + PIECE_SIZE, size) - 1;
+
+        FetchOptions options("GET", headers, "", false, nullptr, PIECE_TIMEOUT);
+        if (!validator.empty())
+            options.headers["If-Range"] = validator;
+        options.range = std::to_string(first) + "-" + std::to_string(last);
+        options.sinkFd = fd;
+        options.sinkOffset = first;
+        options.sinkSync = false;
+        options.multiplex = false;
+        received[piece] = 0;
+        options.progressCallback = [this, piece](int64_t bytes, int64_t total)
+        { received[piece] = bytes; };
+        try
+        {
+            Fetch::fetchAsync(url, options, [this, piece](Response response, const std::string &error)
+                              { finishPiece(piece, response, error); });
+            inFlight++;
+        }
+        catch (const std::exception &e)
+        {
+            failure = e.what();
+        }
+    }
+}
+void SegmentedDownload::finishPiece(size_t piece, const Response &response, const std::string &error)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    inFlight--;
+    if (error.empty() && response.status == 206)
+        completed.push_back(piece);
+    else
+    {
+        received[piece] = 0;
+        if (++attempts[piece] < MAX_ATTEMPTS)
+            pending.push_back(piece);
+        else if (failure.empty())
+            failure = error.empty() ? "Network error " + std::to_string(response.status) : error;
+    }
+    startPieces();
+    condition.notify_all();
+}
+void SegmentedDownload::recordPieces(std::vector<size_t> pieces)
+{
+    // One sync covers every piece written so far; only then are they recorded
+    if (fdatasync(fd) != 0)
+        THROW_EXCEPTION("Failed to write " + path + ": " + strerror(errno));
+    for (size_t piece : pieces)
+        done[piece] = true;
+    saveProgress();
+}
+int64_t SegmentedDownload::downloaded() const
+{
+    int64_t total = 0;
+    for (size_t piece = 0; piece < done.size(); piece++)
+        total += done[piece] ? std::min(PIECE_SIZE, size - (int64_t)piece * PIECE_SIZE) : received[piece].load();
+    return total;
+}
+
+bool SegmentedDownload::run()
+{
+    Response head = Fetch::fetch(url, FetchOptions("HEAD", headers, "", false, nullptr, 30));
+    std::string length = head.header("Content-Length");
+    size = length.empty() ? 0 : std::atoll(length.c_str());
+    if (!head.isOk() || size <= 0 || strcasecmp(head.header("Accept-Ranges").c_str(), "bytes") != 0)
+        return false;
+    validator = head.header("ETag");
+    if (validator.empty())
+        validator = head.header("Last-Modified");
+
+    size_t pieceCount = (size + PIECE_SIZE - 1) / PIECE_SIZE;
+    done.assign(pieceCount, false);
+    bool resuming = loadProgress();
+    if (!resuming)
+        done.assign(pieceCount, false);
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        THROW_EXCEPTION("Failed to open " + path + ": " + strerror(errno));
+    // Sized up front, which also cuts off whatever an older, different download left beyond size
+    if (!resuming && ftruncate(fd, size) != 0)
+        THROW_EXCEPTION("Failed to size " + path + ": " + strerror(errno));
+
+    received.reset(new std::atomic<int64_t>[pieceCount]());
+    attempts.assign(pieceCount, 0);
+    for (size_t piece = 0; piece < pieceCount; piece++)
+        if (!done[piece])
+            pending.push_back(piece);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    startPieces();
+    // Even after a failure, wait for the pieces in flight: their callbacks use this object
+    while (inFlight > 0 || !completed.empty() || (failure.empty() && !pending.empty()))
+    {
+        condition.wait_for(lock, std::chrono::milliseconds(PROGRESS_MILLIS));
+        std::vector<size_t> pieces;
+        pieces.swap(completed);
+        lock.unlock();
+        std::string error;
+        if (!pieces.empty())
+        {
+            try
+            {
+                recordPieces(std::move(pieces));
+            }
+            catch (const std::exception &e)
+            {
+                error = e.what();
+            }
+        }
+        if (progressCallback)
+            progressCallback(downloaded(), size);
+        lock.lock();
+        if (!error.empty() && failure.empty())
+            failure = error;
+    }
+    lock.unlock();
+
+    close(fd);
+    fd = -1;
+    if (!failure.empty())
+        throw std::runtime_error(failure);
+    if (progressCallback)
+        progressCallback(size, size);
+    unlink(progressPath.c_str());
+    return true;
+}
@@ -0,0 +1,80 @@
+// Copyright (C) 2025 Langning Chen
+//
+// This file is part of miniapp.
+//
+// miniapp is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// miniapp is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with miniapp.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "Fetch.hpp"
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <condition_variable>
+#include <unordered_map>
+
+// Downloads url into path as concurrent Range requests of PIECE_SIZE bytes, each over a connection of its own
+// and written in place with pwrite. Finished pieces are synced and then recorded in path + ".progress", so a download interrupted at any
+// point resumes with only the pieces that were in flight, as long as the server still has the same file.
+class SegmentedDownload
+{
+private:
+    std::string url;
+    std::string path;
+    std::string progressPath;
+    size_t connections;
+    std::unordered_map<std::string, std::string> headers;
+    ProgressCallback progressCallback;
+
+    int fd = -1;
+    int64_t size = 0;
+    std::string validator; // ETag, or Last-Modified, sent as If-Range so a replaced file is never mixed in
+    std::vector<bool> done; // run() thread only, set once the piece is synced to disk
+    std::unique_ptr<std::atomic<int64_t>[]> received; // bytes of each unfinished piece so far
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<size_t> pending;
+    std::vector<size_t> completed; // transferred, waiting for run() to sync and record them
+    std::vector<int> attempts;
+    size_t inFlight = 0;
+    std::string failure;
+
+    bool loadProgress();
+    void saveProgress();
+    void startPieces();
+    // On the FetchEngine callback thread, so it only does bookkeeping; the disk work is left to run()
+    void finishPiece(size_t piece, const Response &response, const std::string &error);
+    void recordPieces(std::vector<size_t> pieces);
+    int64_t downloaded() const;
+
+public:
+    static constexpr int64_t PIECE_SIZE = 4 * 1024 * 1024;
+    static constexpr int MAX_ATTEMPTS = 3;
+    static constexpr size_t PIECE_TIMEOUT = 300; // seconds
+    static constexpr int PROGRESS_MILLIS = 500;
+
+    SegmentedDownload(std::string url, std::string path, size_t connections = FetchEngine::MAX_HOST_CONNECTIONS);
+    ~SegmentedDownload();
+    SegmentedDownload &header(std::string name, std::string value);
+    // Called on the thread running run(), at most every PROGRESS_MILLIS
+    SegmentedDownload &onProgress(ProgressCallback callback);
+
+    // false, with nothing written, when the server does not accept Range requests for url.
+    // Throws once a piece has failed MAX_ATTEMPTS times, leaving the file and its progress to resume from.
+    bool run();
+};
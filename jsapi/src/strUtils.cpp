@@ -54,3 +54,20 @@ std::string strUtils::join(const std::vector<std::string> &vec, const std::strin
     }
     return result;
 }
+
+size_t strUtils::utf8Length(const std::string &str)
+{
+    size_t length = 0;
+    for (unsigned char ch : str)
+        if ((ch & 0xC0) != 0x80)
+            length++;
+    return length;
+}
+size_t strUtils::utf16Length(const std::string &str)
+{
+    size_t length = 0;
+    for (unsigned char ch : str)
+        if ((ch & 0xC0) != 0x80)
+            length += (ch >= 0xF0) ? 2 : 1;
+    return length;
+}
@@ -31,4 +31,7 @@ public:
 
     static std::vector<std::string> split(const std::string &str, const std::string &delimiter);
     static std::string join(const std::vector<std::string> &vec, const std::string &delimiter);
+
+    static size_t utf8Length(const std::string &str);
+    static size_t utf16Length(const std::string &str);
 };
@@ -28,20 +28,30 @@ export declare class AI {
 
     static addUserMessage(message: string): Promise<void>;
     static generateResponse(): Promise<string>;
-    static stopGeneration(): void;
+    static startGeneration(conversationId?: string, parentNodeId?: string): string;
+    static fanOut(endpoints: langningchen.Endpoint[], race?: boolean): string[];
+    static stopGeneration(requestId?: string): boolean;
+    static getGenerations(): langningchen.Generation[];
     static getModels(): Promise<string[]>;
     static getUserBalance(): Promise<number>;
 
     static getConversationList(): Promise<langningchen.ConversationNode[]>;
+    static iterateConversations(): Iterable<langningchen.ConversationInfo>;
+    static getDatabaseStats(reset?: boolean): langningchen.DatabaseStats;
     static createConversation(title?: string): Promise<void>;
     static loadConversation(conversationId: string): Promise<void>;
     static deleteConversation(conversationId: string): Promise<void>;
     static updateConversationTitle(conversationId: string, title: string): Promise<void>;
+    static searchConversations(query: string, limit?: number): Promise<langningchen.SearchResult[]>;
 
-    static setSettings(apiKey: string, baseUrl: string, modelName: string, maxTokens: number, temperature: number, topP: number, systemPrompt: string): void;
+    static setSettings(apiKey: string, baseUrl: string, modelName: string, maxTokens: number, temperature: number, topP: number, systemPrompt: string, contextTokens?: number): void;
     static getSettings(): langningchen.SettingsResponse;
 
     static on(event: 'ai_stream', callback: (data: string) => void): void;
+    static on(event: `ai_stream_${string}`, callback: (data: string) => void): void;
+    static on(event: `ai_done_${string}`, callback: (data: langningchen.GenerationResult) => void): void;
+    static on(event: 'ai_conversations_changed', callback: (data: langningchen.ConversationChange) => void): void;
+    static off(event: 'ai_conversations_changed', callback: (data: langningchen.ConversationChange) => void): void;
 }
 
 export declare class IME {
@@ -49,6 +59,7 @@ export declare class IME {
     static getCandidates(rawPinyin: string): langningchen.Candidate[];
     static updateWordFrequency(pinyin: langningchen.Pinyin, hanZi: string): void;
     static splitPinyin(rawPinyin: string): langningchen.Pinyin;
+    static getDatabaseStats(reset?: boolean): langningchen.DatabaseStats;
 }
 
 export declare class ScanInput {
@@ -56,3 +67,12 @@ export declare class ScanInput {
     static deinitialize(): Promise<void>;
     static on(event: 'scan_input', callback: (data: string) => void): void;
 }
+
+export declare class Database {
+    static open(path: string, options?: langningchen.DatabaseOpenOptions): Promise<number>;
+    static close(handle: number): Promise<void>;
+    static query(handle: number, sql: string, params?: langningchen.SqlValue[]): Promise<langningchen.QueryResult>;
+    static exec(handle: number, sql: string, params?: langningchen.SqlValue[]): Promise<void>;
+    static queryBatch(handle: number, sql: string, paramSets: langningchen.SqlValue[][]): Promise<langningchen.QueryResult[]>;
+    static execBatch(handle: number, sql: string, paramSets: langningchen.SqlValue[][]): Promise<number>;
+}
@@ -48,6 +48,88 @@ export interface ConversationInfo {
     updatedAt: number;
 }
 
+export interface ConversationChange {
+    changed: ConversationInfo[];
+    removed: boolean;
+}
+
+export interface StatementStats {
+    sql: string;
+    calls: number;
+    rows: number;
+    cacheHits: number;
+    prepares: number;
+    prepareTime: number;
+    maxPrepareTime: number;
+    stepTime: number;
+    maxStepTime: number;
+}
+
+export interface SlowStatement {
+    sql: string;
+    stepTime: number;
+    rows: number;
+    timestamp: string;
+}
+
+export interface DatabaseStats {
+    statements: StatementStats[];
+    slowStatements: SlowStatement[];
+}
+
+export type SqlValue = number | string | boolean | null | ArrayBuffer;
+
+export interface DatabaseOpenOptions {
+    readOnly?: boolean;
+    readConnections?: number;
+    profile?: boolean;
+}
+
+// values[i] is an ArrayBuffer of float64 (wrap it in a Float64Array, NULL is NaN) when column i only holds
+// numbers and NULLs, an array with one value per row otherwise
+export interface QueryResult {
+    columns: string[];
+    rowCount: number;
+    values: (ArrayBuffer | SqlValue[])[];
+}
+
+export interface SearchMatch {
+    start: number;
+    length: number;
+}
+
+export interface SearchHit {
+    nodeId: string;
+    role: ROLE;
+    snippet: string;
+    matches: SearchMatch[];
+}
+
+export interface SearchResult {
+    id: string;
+    title: string;
+    updatedAt: string;
+    rank: number;
+    hits: SearchHit[];
+}
+
+export interface Endpoint {
+    apiKey?: string;
+    baseUrl?: string;
+    modelName?: string;
+}
+
+export interface Generation {
+    requestId: string;
+    conversationId: string;
+    parentNodeId: string;
+}
+
+export interface GenerationResult {
+    content: string;
+    error: string;
+}
+
 
 export interface SettingsResponse {
     apiKey: string;
@@ -57,6 +139,7 @@ export interface SettingsResponse {
     temperature: number;
     topP: number;
     systemPrompt: string;
+    contextTokens: number;
 }
 
 
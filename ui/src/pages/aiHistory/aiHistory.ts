@@ -21,6 +21,7 @@ import { showError, showSuccess } from '../../components/ToastMessage';
 import { hideLoading, showLoading } from '../../components/Loading';
 import { openSoftKeyboard } from '../../utils/softKeyboardUtils';
 import { formatTime } from '../../utils/timeUtils';
+import { ConversationChange } from '../../@types/langningchen';
 
 export type aiHistoryOptions = {};
 
@@ -38,12 +39,17 @@ const aiHistory = defineComponent({
     async mounted() {
         try {
             AI.initialize()
+            AI.on('ai_conversations_changed', this.onConversationsChanged);
             await this.loadConversationList();
         } catch (e) {
             showError(e as string || 'AI 初始化失败');
         }
     },
 
+    beforeUnmount() {
+        AI.off('ai_conversations_changed', this.onConversationsChanged);
+    },
+
     computed: {
         filteredConversations(): any[] {
             let filtered = [...this.conversationList];
@@ -59,6 +65,22 @@ const aiHistory = defineComponent({
     },
 
     methods: {
+        onConversationsChanged(change: ConversationChange) {
+            if (change.removed) {
+                this.loadConversationList();
+                return;
+            }
+            for (const conversation of change.changed) {
+                const index = this.conversationList.findIndex(conv => conv.id === conversation.id);
+                if (index !== -1) {
+                    this.conversationList[index] = conversation;
+                } else {
+                    this.conversationList.push(conversation);
+                }
+            }
+            this.$forceUpdate();
+        },
+
         async loadConversationList() {
             showLoading();
             AI.getConversationList().then((list) => {
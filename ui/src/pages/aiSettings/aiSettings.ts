@@ -35,6 +35,7 @@ const aiSettings = defineComponent({
             temperature: 0,
             topP: 0,
             systemPrompt: '',
+            contextTokens: 0,
 
             userBalance: 0.0,
             availableModels: [] as string[],
@@ -63,6 +64,7 @@ const aiSettings = defineComponent({
                 this.topP = settings.topP;
                 this.maxTokens = settings.maxTokens;
                 this.systemPrompt = settings.systemPrompt;
+                this.contextTokens = settings.contextTokens;
             } catch (e) {
                 showError(e as string || '加载设置失败');
             }
@@ -101,7 +103,8 @@ const aiSettings = defineComponent({
             try {
                 AI.setSettings(this.apiKey, this.baseUrl,
                     this.modelName, this.maxTokens,
-                    this.temperature, this.topP, this.systemPrompt,);
+                    this.temperature, this.topP, this.systemPrompt,
+                    this.contextTokens);
                 showSuccess('设置已保存');
             } catch (e) {
                 showError(e as string || '保存设置失败');
@@ -140,6 +143,18 @@ const aiSettings = defineComponent({
             );
         },
 
+        editContextTokens() {
+            openSoftKeyboard(
+                () => this.contextTokens.toString(),
+                (value) => { this.contextTokens = parseInt(value); this.$forceUpdate(); },
+                (value) => {
+                    const parsed = parseInt(value);
+                    if (isNaN(parsed)) { return '请输入有效的数字'; }
+                    if (parsed < 0) { return '上下文长度不能为负数'; }
+                }
+            );
+        },
+
         editTemperature() {
             openSoftKeyboard(
                 () => this.temperature.toFixed(1),